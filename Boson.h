@@ -10,24 +10,42 @@
 
 class Boson : public Particle {
 protected:
-    std::string type_;
+    ParticleId id_;
     double charge_;
     double spin_;
     FourMomentum fourMomentum_;
     std::vector<std::shared_ptr<Particle>> decayProducts;  // Container for decay products
 
+    static ParticleId checkedType(ParticleId id) {
+        if (!isBoson(id)) {
+            throw std::invalid_argument("Not a boson type: " + std::string(particleName(id)));
+        }
+        return id;
+    }
+
 public:
-    Boson(const std::string& type, double charge, double spin, const FourMomentum& fourMomentum)
-        : type_(type), charge_(charge), spin_(spin), fourMomentum_(fourMomentum) {
+    Boson(ParticleId id, double charge, double spin, const FourMomentum& fourMomentum)
+        : id_(checkedType(id)), charge_(charge), spin_(spin), fourMomentum_(fourMomentum) {
+        PARTICLE_COUNT(BosonConstructed);
         validateMass(); // Validate the mass at construction
     }
 
+    // Charge and spin taken from the particle table
+    Boson(ParticleId id, const FourMomentum& fourMomentum)
+        : Boson(id, particleProperties(id).charge, particleProperties(id).spin, fourMomentum) {}
+
+    // Type given by name, e.g. "W+"; looked up once in the particle table. Throws
+    // std::invalid_argument for names that are not bosons.
+    Boson(const std::string& type, double charge, double spin, const FourMomentum& fourMomentum)
+        : Boson(particleIdFromName(type), charge, spin, fourMomentum) {}
+
     virtual ~Boson() {}
 
     double charge() const override { return charge_; }
     double spin() const override { return spin_; }
     FourMomentum getFourMomentum() const override { return fourMomentum_; }
-    std::string getType() const override { return type_; }
+    std::string_view getType() const override { return particleName(id_); }
+    ParticleId getId() const override { return id_; }
 
     // Manage decay products
     void addDecayProduct(const std::shared_ptr<Particle>& particle) {
@@ -38,7 +56,7 @@ public:
         decayProducts.clear();
     }
 
-    const std::vector<std::shared_ptr<Particle>>& getDecayProducts() const {
+    const std::vector<std::shared_ptr<Particle>>& getDecayProducts() const override {
         return decayProducts;
     }
 
@@ -67,20 +85,20 @@ private:
     void validateMass() {
         const double tolerance = 1.0; // MeV tolerance for mass validation
         double expectedMass = getExpectedMassForType();
-        if (std::fabs(fourMomentum_.invariantMass() - expectedMass) > tolerance) {
-            std::cerr << "Warning: Inconsistent mass for " << type_
-                      << ". Expected: " << expectedMass << " MeV, Found: " 
-                      << fourMomentum_.invariantMass() << " MeV." << std::endl;
+        double derivedMass = fourMomentum_.invariantMass();
+        if (std::fabs(derivedMass - expectedMass) > tolerance) {
+            PARTICLE_COUNT(BosonMassFlagged);
+            if (Validation::fail(ValidationIssue::MassMismatch, getType(), expectedMass, derivedMass)) {
+                std::cerr << "Warning: Inconsistent mass for " << getType()
+                          << ". Expected: " << expectedMass << " MeV, Found: " 
+                          << derivedMass << " MeV." << std::endl;
+            }
         }
     }
 
     double getExpectedMassForType() const {
-        // These values should be updated according to the particle data group or similar reliable sources
-        if (type_ == "W+") return 80379;
-        if (type_ == "W-") return 80379;
-        if (type_ == "Z0") return 91188;
-        if (type_ == "Higgs") return 125100;
-        return 0;  // Default for unknown types
+        // Table values should be updated according to the particle data group or similar reliable sources
+        return particleProperties(id_).mass;
     }
 };
 
@@ -0,0 +1,99 @@
+#include "CalorimeterStore.h"
+#include "FourMomentum.h"
+#include <cmath>
+
+namespace {
+
+// Lane-wise check and correction over SoA columns. The invariant mass is formed in the same
+// order as the vector FourMomentum::operator*, (E^2 - py^2) - (px^2 + pz^2), so corrected
+// momenta match the per-particle path bit for bit unless the compiler fuses multiply-adds
+// (-march=native with FMA), which can change the last bit.
+#if defined(FOURMOMENTUM_USE_AVX)
+using Lanes = __m256d;
+constexpr std::size_t laneCount = 4;
+inline Lanes splat(double x) { return _mm256_set1_pd(x); }
+inline Lanes loadLanes(const double* p) { return _mm256_loadu_pd(p); }
+inline void storeLanes(double* p, Lanes v) { _mm256_storeu_pd(p, v); }
+inline Lanes add(Lanes a, Lanes b) { return _mm256_add_pd(a, b); }
+inline Lanes sub(Lanes a, Lanes b) { return _mm256_sub_pd(a, b); }
+inline Lanes mul(Lanes a, Lanes b) { return _mm256_mul_pd(a, b); }
+inline Lanes div(Lanes a, Lanes b) { return _mm256_div_pd(a, b); }
+inline Lanes sqrtLanes(Lanes a) { return _mm256_sqrt_pd(a); }
+inline Lanes maxLanes(Lanes a, Lanes b) { return _mm256_max_pd(a, b); }
+inline Lanes absLanes(Lanes a) { return _mm256_andnot_pd(_mm256_set1_pd(-0.0), a); }
+inline Lanes greater(Lanes a, Lanes b) { return _mm256_cmp_pd(a, b, _CMP_GT_OQ); }
+inline Lanes both(Lanes a, Lanes b) { return _mm256_and_pd(a, b); }
+inline Lanes select(Lanes mask, Lanes yes, Lanes no) { return _mm256_blendv_pd(no, yes, mask); }
+inline int laneMask(Lanes mask) { return _mm256_movemask_pd(mask); }
+#elif defined(FOURMOMENTUM_USE_SSE2)
+using Lanes = __m128d;
+constexpr std::size_t laneCount = 2;
+inline Lanes splat(double x) { return _mm_set1_pd(x); }
+inline Lanes loadLanes(const double* p) { return _mm_loadu_pd(p); }
+inline void storeLanes(double* p, Lanes v) { _mm_storeu_pd(p, v); }
+inline Lanes add(Lanes a, Lanes b) { return _mm_add_pd(a, b); }
+inline Lanes sub(Lanes a, Lanes b) { return _mm_sub_pd(a, b); }
+inline Lanes mul(Lanes a, Lanes b) { return _mm_mul_pd(a, b); }
+inline Lanes div(Lanes a, Lanes b) { return _mm_div_pd(a, b); }
+inline Lanes sqrtLanes(Lanes a) { return _mm_sqrt_pd(a); }
+inline Lanes maxLanes(Lanes a, Lanes b) { return _mm_max_pd(a, b); }
+inline Lanes absLanes(Lanes a) { return _mm_andnot_pd(_mm_set1_pd(-0.0), a); }
+inline Lanes greater(Lanes a, Lanes b) { return _mm_cmpgt_pd(a, b); }
+inline Lanes both(Lanes a, Lanes b) { return _mm_and_pd(a, b); }
+inline Lanes select(Lanes mask, Lanes yes, Lanes no) { return _mm_or_pd(_mm_and_pd(mask, yes), _mm_andnot_pd(mask, no)); }
+inline int laneMask(Lanes mask) { return _mm_movemask_pd(mask); }
+#endif
+
+} // namespace
+
+std::size_t CalorimeterStore::reconcile(const Range* ranges, double* E, double* px, double* py, double* pz,
+                                        double* sums, std::uint8_t* mismatch, std::uint8_t* adjusted, std::size_t n) const {
+    // Layer sums first: one sequential pass over the shared buffer
+    for (std::size_t i = 0; i < n; i++) sums[i] = sum(ranges[i]);
+
+    std::size_t mismatches = 0;
+    std::size_t i = 0;
+#if defined(FOURMOMENTUM_USE_AVX) || defined(FOURMOMENTUM_USE_SSE2)
+    const Lanes zero = splat(0.0), energyTol = splat(energyTolerance), massTol = splat(massTolerance);
+    for (; i + laneCount <= n; i += laneCount) {
+        Lanes s = loadLanes(sums + i), e = loadLanes(E + i);
+        Lanes off = greater(absLanes(sub(s, e)), energyTol);
+        int offMask = laneMask(off);
+        for (std::size_t lane = 0; lane < laneCount; lane++) {
+            mismatch[i + lane] = (offMask >> lane) & 1;
+            mismatches += mismatch[i + lane];
+            adjusted[i + lane] = 0;
+        }
+        if (!offMask) continue;  // The common case: every layer sum agrees with E
+
+        Lanes x = loadLanes(px + i), y = loadLanes(py + i), z = loadLanes(pz + i);
+        Lanes mass = sqrtLanes(maxLanes(zero, sub(sub(mul(e, e), mul(y, y)), add(mul(x, x), mul(z, z)))));
+        Lanes adjust = both(off, greater(absLanes(sub(mass, s)), massTol));
+        int adjustMask = laneMask(adjust);
+        if (!adjustMask) continue;
+        for (std::size_t lane = 0; lane < laneCount; lane++) adjusted[i + lane] = (adjustMask >> lane) & 1;
+        Lanes factor = div(s, mass);
+        Lanes nx = mul(x, factor), ny = mul(y, factor), nz = mul(z, factor);
+        Lanes ne = sqrtLanes(add(add(add(mul(nx, nx), mul(ny, ny)), mul(nz, nz)), mul(s, s)));
+        storeLanes(E + i, select(adjust, ne, e));
+        storeLanes(px + i, select(adjust, nx, x));
+        storeLanes(py + i, select(adjust, ny, y));
+        storeLanes(pz + i, select(adjust, nz, z));
+    }
+#endif
+    for (; i < n; i++) {
+        mismatch[i] = std::abs(sums[i] - E[i]) > energyTolerance;
+        adjusted[i] = 0;
+        if (!mismatch[i]) continue;
+        mismatches++;
+        FourMomentum p = FourMomentum::unchecked(E[i], px[i], py[i], pz[i]);
+        if (!(std::abs(p.invariantMass() - sums[i]) > massTolerance)) continue;
+        adjusted[i] = 1;
+        p.adjustForPhysicalConsistency(sums[i]);
+        E[i] = p.data()[0];
+        px[i] = p.data()[1];
+        py[i] = p.data()[2];
+        pz[i] = p.data()[3];
+    }
+    return mismatches;
+}
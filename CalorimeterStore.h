@@ -0,0 +1,83 @@
+#ifndef CALORIMETER_STORE_H
+#define CALORIMETER_STORE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+// Read-only view of one electron's calorimeter layer energies
+class CalorimeterLayers {
+private:
+    const double* data_ = nullptr;
+    std::size_t size_ = 0;
+
+public:
+    CalorimeterLayers() = default;
+    CalorimeterLayers(const double* data, std::size_t size) : data_(data), size_(size) {}
+
+    const double* data() const { return data_; }
+    std::size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+    const double* begin() const { return data_; }
+    const double* end() const { return data_ + size_; }
+    double operator[](std::size_t i) const { return data_[i]; }
+};
+
+// Calorimeter layers of many electrons in one contiguous buffer; each electron keeps only
+// the offset and length of its layers. Appending may move the buffer, so views returned by
+// layers() are valid until the next append or clear().
+class CalorimeterStore {
+public:
+    struct Range {
+        std::uint32_t offset = 0;
+        std::uint32_t length = 0;
+    };
+
+    // Same tolerances as the check in the Electron constructor
+    static constexpr double energyTolerance = 1e-3;
+    static constexpr double massTolerance = 1e-4;
+
+    Range append(const double* layers, std::size_t count) {
+        if (buffer_.size() + count > UINT32_MAX) {
+            throw std::length_error("CalorimeterStore holds at most 2^32 - 1 layer energies.");
+        }
+        Range range{static_cast<std::uint32_t>(buffer_.size()), static_cast<std::uint32_t>(count)};
+        buffer_.insert(buffer_.end(), layers, layers + count);
+        return range;
+    }
+
+    Range append(const std::vector<double>& layers) {
+        return append(layers.data(), layers.size());
+    }
+
+    CalorimeterLayers layers(Range range) const {
+        return CalorimeterLayers(buffer_.data() + range.offset, range.length);
+    }
+
+    // Summed in layer order, as std::accumulate does in the Electron constructor
+    double sum(Range range) const {
+        double total = 0.0;
+        for (std::uint32_t i = 0; i < range.length; i++) total += buffer_[range.offset + i];
+        return total;
+    }
+
+    std::size_t size() const { return buffer_.size(); }
+    void reserve(std::size_t layerCount) { buffer_.reserve(layerCount); }
+    void clear() { buffer_.clear(); }
+
+    // Batch form of the Electron constructor's calorimeter check for n electrons. Electron
+    // i has layers ranges[i] and four-momentum (E[i], px[i], py[i], pz[i]); sums[i] receives
+    // its layer sum. Where the sum differs from E by more than energyTolerance, mismatch[i]
+    // is set to 1 and the momentum is corrected in place as
+    // FourMomentum::adjustForPhysicalConsistency would. That leaves momenta whose invariant
+    // mass is already within massTolerance of the sum unchanged, so adjusted[i] is 1 only
+    // where the momentum was rewritten. Returns the number of mismatches.
+    std::size_t reconcile(const Range* ranges, double* E, double* px, double* py, double* pz,
+                          double* sums, std::uint8_t* mismatch, std::uint8_t* adjusted, std::size_t n) const;
+
+private:
+    std::vector<double> buffer_;
+};
+
+#endif // CALORIMETER_STORE_H
@@ -0,0 +1,92 @@
+#ifndef CATALOGUE_AGGREGATES_H
+#define CATALOGUE_AGGREGATES_H
+
+#include "FourMomentum.h"
+#include "ParticleColumns.h"
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Neumaier's compensated summation: the rounding error of every addition is carried in a
+// second term, so a long running total stays accurate to about one ulp whatever the order.
+class CompensatedSum {
+private:
+    double sum_ = 0.0;
+    double compensation_ = 0.0;
+
+public:
+    void add(double value) {
+        double t = sum_ + value;
+        if (std::fabs(sum_) >= std::fabs(value)) {
+            compensation_ += (sum_ - t) + value;
+        } else {
+            compensation_ += (value - t) + sum_;
+        }
+        sum_ = t;
+    }
+
+    double value() const { return sum_ + compensation_; }
+};
+
+// Running totals over the rows of a catalogue, updated in O(1) per added row. Totals do
+// not depend on row order, so reordering the rows leaves them valid.
+class CatalogueAggregates {
+private:
+    CompensatedSum energy_, px_, py_, pz_, charge_;
+    long long leptonNumber_ = 0;
+    long long baryonNumber_ = 0;
+    std::size_t size_ = 0;
+    std::vector<int> countsByType_;  // Indexed by ParticleColumns type id
+
+public:
+    void add(const ParticleColumns& columns, std::size_t row) {
+        energy_.add(columns.energy()[row]);
+        px_.add(columns.px()[row]);
+        py_.add(columns.py()[row]);
+        pz_.add(columns.pz()[row]);
+        charge_.add(columns.charge()[row]);
+        leptonNumber_ += columns.leptonNumber()[row];
+        baryonNumber_ += columns.baryonNumber()[row];
+        std::uint16_t type = columns.typeId()[row];
+        if (type >= countsByType_.size()) countsByType_.resize(type + 1, 0);
+        countsByType_[type]++;
+        size_++;
+    }
+
+    // For a row whose momentum was corrected in place
+    void replaceMomentum(const FourMomentum& before, const FourMomentum& after) {
+        energy_.add(-before.data()[0]);
+        px_.add(-before.data()[1]);
+        py_.add(-before.data()[2]);
+        pz_.add(-before.data()[3]);
+        energy_.add(after.data()[0]);
+        px_.add(after.data()[1]);
+        py_.add(after.data()[2]);
+        pz_.add(after.data()[3]);
+    }
+
+    void clear() {
+        *this = CatalogueAggregates();
+    }
+
+    std::size_t size() const { return size_; }
+
+    // Unchecked: rounding can leave a sum of physical momenta a few ulps spacelike
+    FourMomentum totalFourMomentum() const {
+        return FourMomentum::unchecked(energy_.value(), px_.value(), py_.value(), pz_.value());
+    }
+
+    double totalCharge() const { return charge_.value(); }
+    long long totalLeptonNumber() const { return leptonNumber_; }
+    long long totalBaryonNumber() const { return baryonNumber_; }
+
+    int count(std::uint16_t type) const {
+        return type < countsByType_.size() ? countsByType_[type] : 0;
+    }
+
+    // Counts by type id; may be shorter than ParticleColumns::typeCount()
+    const std::vector<int>& countsByType() const { return countsByType_; }
+};
+
+#endif // CATALOGUE_AGGREGATES_H
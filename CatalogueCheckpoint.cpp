@@ -0,0 +1,306 @@
+#include "CatalogueCheckpoint.h"
+#include "Validation.h"
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <system_error>
+#include <vector>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+constexpr char CatalogueCheckpoint::magic[8];
+
+namespace {
+
+constexpr std::uint64_t prime1 = 0x9E3779B185EBCA87ull;
+constexpr std::uint64_t prime2 = 0xC2B2AE3D27D4EB4Full;
+constexpr std::uint64_t prime3 = 0x165667B19E3779F9ull;
+constexpr std::uint64_t prime4 = 0x85EBCA77C2B2AE63ull;
+constexpr std::uint64_t prime5 = 0x27D4EB2F165667C5ull;
+
+constexpr std::uint64_t alignTo8(std::uint64_t offset) {
+    return (offset + 7) & ~std::uint64_t{7};
+}
+
+std::uint64_t rotl(std::uint64_t x, int r) {
+    return (x << r) | (x >> (64 - r));
+}
+
+std::uint64_t load64(const unsigned char* p) {
+    std::uint64_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+std::uint32_t load32(const unsigned char* p) {
+    std::uint32_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+std::uint64_t mixRound(std::uint64_t acc, std::uint64_t input) {
+    acc += input * prime2;
+    return rotl(acc, 31) * prime1;
+}
+
+std::uint64_t mergeRound(std::uint64_t acc, std::uint64_t lane) {
+    acc ^= mixRound(0, lane);
+    return acc * prime1 + prime4;
+}
+
+std::uint64_t headerChecksum(const CheckpointChunkHeader& header) {
+    return CatalogueCheckpoint::checksum(&header, offsetof(CheckpointChunkHeader, headerChecksum));
+}
+
+// Reads consecutive chunks from a log, checking everything but the image checksum, which
+// callers verify where it suits them (in parallel on restore)
+class ChunkReader {
+private:
+    std::FILE* file_;
+    std::uint64_t fileSize_;
+    std::uint64_t offset_ = 0;
+    std::uint64_t nextRow_ = 0;
+
+public:
+    struct Chunk {
+        CheckpointChunkHeader header;
+        std::vector<std::byte> image;
+    };
+
+    ChunkReader(std::FILE* file, std::uint64_t fileSize) : file_(file), fileSize_(fileSize) {}
+
+    // End of the last chunk returned by next(), i.e. the length of the valid prefix so far
+    std::uint64_t offset() const { return offset_; }
+    std::uint64_t rows() const { return nextRow_; }
+
+    // False at the end of the log or at the first chunk with a bad header or short image
+    bool next(Chunk& chunk) {
+        if (fileSize_ - offset_ < sizeof(CheckpointChunkHeader)) return false;
+        CheckpointChunkHeader& header = chunk.header;
+        if (std::fread(&header, sizeof(header), 1, file_) != 1) return false;
+        if (std::memcmp(header.magic, CatalogueCheckpoint::magic, sizeof(header.magic)) != 0 ||
+            header.headerChecksum != headerChecksum(header) || header.firstRow != nextRow_) {
+            return false;
+        }
+        std::uint64_t padded = alignTo8(header.imageSize);
+        if (padded < header.imageSize || padded > fileSize_ - offset_ - sizeof(header)) return false;
+        chunk.image.resize(static_cast<std::size_t>(padded));
+        if (padded != 0 && std::fread(chunk.image.data(), 1, chunk.image.size(), file_) != chunk.image.size()) return false;
+        chunk.image.resize(static_cast<std::size_t>(header.imageSize));
+        offset_ += sizeof(header) + padded;
+        nextRow_ += header.rowCount;
+        return true;
+    }
+};
+
+bool imageValid(const ChunkReader::Chunk& chunk) {
+    return chunk.header.imageChecksum == CatalogueCheckpoint::checksum(chunk.image.data(), chunk.image.size());
+}
+
+} // namespace
+
+std::uint64_t CatalogueCheckpoint::checksum(const void* data, std::size_t size) {
+    const unsigned char* p = static_cast<const unsigned char*>(data);
+    const unsigned char* end = p + size;
+    std::uint64_t hash;
+    if (size >= 32) {
+        std::uint64_t v1 = prime1 + prime2, v2 = prime2, v3 = 0, v4 = 0 - prime1;
+        const unsigned char* limit = end - 32;
+        do {
+            v1 = mixRound(v1, load64(p));
+            v2 = mixRound(v2, load64(p + 8));
+            v3 = mixRound(v3, load64(p + 16));
+            v4 = mixRound(v4, load64(p + 24));
+            p += 32;
+        } while (p <= limit);
+        hash = rotl(v1, 1) + rotl(v2, 7) + rotl(v3, 12) + rotl(v4, 18);
+        hash = mergeRound(hash, v1);
+        hash = mergeRound(hash, v2);
+        hash = mergeRound(hash, v3);
+        hash = mergeRound(hash, v4);
+    } else {
+        hash = prime5;
+    }
+    hash += static_cast<std::uint64_t>(size);
+    for (; p + 8 <= end; p += 8) hash = rotl(hash ^ mixRound(0, load64(p)), 27) * prime1 + prime4;
+    if (p + 4 <= end) {
+        hash = rotl(hash ^ (static_cast<std::uint64_t>(load32(p)) * prime1), 23) * prime2 + prime3;
+        p += 4;
+    }
+    for (; p < end; p++) hash = rotl(hash ^ (*p * prime5), 11) * prime1;
+    hash ^= hash >> 33;
+    hash *= prime2;
+    hash ^= hash >> 29;
+    hash *= prime3;
+    hash ^= hash >> 32;
+    return hash;
+}
+
+CatalogueCheckpoint::CatalogueCheckpoint(std::string path, Config config)
+    : path_(std::move(path)), config_(config), executor_(config.threads) {
+    if (config_.chunkRows == 0) {
+        throw std::invalid_argument("CatalogueCheckpoint chunkRows must be positive.");
+    }
+    std::error_code error;
+    std::uint64_t fileSize = std::filesystem::file_size(path_, error);
+    if (!error && fileSize > 0) {
+        std::FILE* existing = std::fopen(path_.c_str(), "rb");
+        if (!existing) throw std::runtime_error("Cannot open checkpoint log: " + path_);
+        ChunkReader reader(existing, fileSize);
+        ChunkReader::Chunk chunk;
+        std::uint64_t valid = 0;
+        while (reader.next(chunk) && imageValid(chunk)) {
+            valid = reader.offset();
+            persistedRows_ = static_cast<std::size_t>(reader.rows());
+            chunkCount_++;
+        }
+        std::fclose(existing);
+        validBytes_ = valid;
+        if (valid < fileSize) {
+            std::cerr << "Warning: Checkpoint log " << path_ << " has " << (fileSize - valid)
+                      << " invalid trailing bytes; truncating after " << chunkCount_ << " chunks." << std::endl;
+            std::filesystem::resize_file(path_, valid);
+        }
+    }
+    file_ = std::fopen(path_.c_str(), "ab");
+    if (!file_) throw std::runtime_error("Cannot open checkpoint log for writing: " + path_);
+}
+
+CatalogueCheckpoint::~CatalogueCheckpoint() {
+    if (file_) std::fclose(file_);
+}
+
+void CatalogueCheckpoint::rollBack(const char* what) {
+    // Closing discards the stdio buffer's hold on the file; whatever it flushes is cut off
+    // by the truncation that follows
+    std::fclose(file_);
+    file_ = nullptr;
+    std::error_code error;
+    std::filesystem::resize_file(path_, validBytes_, error);
+    if (!error) file_ = std::fopen(path_.c_str(), "ab");
+    if (!file_) {
+        failed_ = true;
+        std::cerr << "Warning: Cannot truncate checkpoint log " << path_ << " after a failed append; no further checkpoints will be written." << std::endl;
+    }
+    throw std::runtime_error(std::string(what) + path_);
+}
+
+std::size_t CatalogueCheckpoint::checkpoint(const ParticleCatalogue& catalogue) {
+    if (failed_) throw std::runtime_error("Checkpoint log is in a failed state: " + path_);
+    const auto& particles = catalogue.getParticles();
+    if (particles.size() < persistedRows_) {
+        throw std::logic_error("Catalogue has fewer rows than its checkpoint log; start a new log after sorting or clearing.");
+    }
+    std::size_t rows = particles.size() - persistedRows_;
+    if (rows == 0) return 0;
+
+    std::size_t chunks = ParallelExecutor::blockCount(rows, config_.chunkRows);
+    std::vector<CheckpointChunkHeader> headers(chunks);
+    std::vector<std::vector<std::byte>> images(chunks);
+    executor_.forEachBlock(chunks, [&](std::size_t c) {
+        std::size_t begin = persistedRows_ + c * config_.chunkRows;
+        std::size_t end = std::min(particles.size(), begin + config_.chunkRows);
+        images[c] = CatalogueFile::encode(catalogue, begin, end);
+        CheckpointChunkHeader& header = headers[c];
+        std::memcpy(header.magic, magic, sizeof(magic));
+        header.firstRow = begin;
+        header.rowCount = end - begin;
+        header.imageSize = images[c].size();
+        header.imageChecksum = checksum(images[c].data(), images[c].size());
+        header.headerChecksum = headerChecksum(header);
+    });
+
+    static const char padding[8] = {};
+    std::uint64_t written = 0;
+    for (std::size_t c = 0; c < chunks; c++) {
+        std::size_t pad = static_cast<std::size_t>(alignTo8(images[c].size()) - images[c].size());
+        if (std::fwrite(&headers[c], sizeof(CheckpointChunkHeader), 1, file_) != 1 ||
+            std::fwrite(images[c].data(), 1, images[c].size(), file_) != images[c].size() ||
+            (pad != 0 && std::fwrite(padding, 1, pad, file_) != pad)) {
+            rollBack("Failed to write checkpoint log: ");
+        }
+        written += sizeof(CheckpointChunkHeader) + images[c].size() + pad;
+    }
+    if (std::fflush(file_) != 0) rollBack("Failed to write checkpoint log: ");
+    if (config_.sync) {
+#ifdef _WIN32
+        int synced = _commit(_fileno(file_));
+#else
+        int synced = fsync(fileno(file_));
+#endif
+        if (synced != 0) rollBack("Failed to sync checkpoint log: ");
+    }
+    validBytes_ += written;
+    persistedRows_ += rows;
+    chunkCount_ += chunks;
+    return rows;
+}
+
+CatalogueCheckpoint::RestoreSummary CatalogueCheckpoint::restore(const std::string& path, ParticleCatalogue& catalogue, unsigned threads) {
+    std::error_code error;
+    std::uint64_t fileSize = std::filesystem::file_size(path, error);
+    if (error) throw std::runtime_error("Cannot open checkpoint log: " + path);
+    std::unique_ptr<std::FILE, int (*)(std::FILE*)> file(std::fopen(path.c_str(), "rb"), &std::fclose);
+    if (!file) throw std::runtime_error("Cannot open checkpoint log: " + path);
+
+    ParallelExecutor executor(threads);
+    ChunkReader reader(file.get(), fileSize);
+    RestoreSummary summary;
+    std::uint64_t validBytes = 0;
+
+    // Chunks are read in waves so memory stays bounded by a few chunks per thread
+    std::size_t wave = 2 * static_cast<std::size_t>(executor.getThreadCount());
+    std::vector<ChunkReader::Chunk> chunks(wave);
+    std::vector<std::uint64_t> chunkEnds(wave);
+    std::vector<std::vector<std::shared_ptr<Particle>>> decoded(wave);
+    std::vector<unsigned char> valid(wave);
+    bool done = false;
+    while (!done) {
+        std::size_t count = 0;
+        while (count < wave && reader.next(chunks[count])) chunkEnds[count++] = reader.offset();
+        if (count < wave) done = true;
+
+        executor.forEachBlock(count, [&](std::size_t c) {
+            decoded[c].clear();
+            valid[c] = 0;
+            if (!imageValid(chunks[c])) return;
+            ValidationScope scope = catalogue.validationScope();
+            try {
+                CatalogueImage image(chunks[c].image.data(), chunks[c].image.size());
+                if (image.topLevelCount() != chunks[c].header.rowCount) return;
+                decoded[c] = image.materializeTopLevel();
+                valid[c] = 1;
+            } catch (const std::runtime_error&) {
+                // A well-formed header over a malformed image counts as a damaged chunk
+            }
+        });
+
+        std::size_t rows = 0;
+        for (std::size_t c = 0; c < count && valid[c]; c++) rows += decoded[c].size();
+        catalogue.reserve(catalogue.getTotalNumberOfParticles() + rows);
+        for (std::size_t c = 0; c < count; c++) {
+            if (!valid[c]) {
+                done = true;
+                break;
+            }
+            for (const auto& particle : decoded[c]) catalogue.addParticle(particle);
+            summary.chunks++;
+            summary.rows += decoded[c].size();
+            validBytes = chunkEnds[c];
+            decoded[c].clear();
+        }
+    }
+    summary.discardedBytes = static_cast<std::size_t>(fileSize - validBytes);
+    if (summary.discardedBytes != 0) {
+        std::cerr << "Warning: Ignoring " << summary.discardedBytes << " invalid trailing bytes of checkpoint log "
+                  << path << " after " << summary.chunks << " chunks." << std::endl;
+    }
+    return summary;
+}
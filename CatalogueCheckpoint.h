@@ -0,0 +1,102 @@
+#ifndef CATALOGUE_CHECKPOINT_H
+#define CATALOGUE_CHECKPOINT_H
+
+#include "CatalogueFile.h"
+#include "ParallelExecutor.h"
+#include "ParticleCatalogue.h"
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+// Append-only checkpoint log (little-endian, chunks 8-byte aligned):
+//
+//   CheckpointChunkHeader
+//   CatalogueFile image of catalogue rows [firstRow, firstRow + rowCount), padded to 8 bytes
+//   CheckpointChunkHeader
+//   ...
+//
+// Every chunk carries a checksum of its header and of its image, so a chunk torn by a crash
+// mid-write, or damaged later, is detected and everything from it on is ignored.
+
+struct CheckpointChunkHeader {
+    char magic[8];
+    std::uint64_t firstRow;        // Catalogue row of the chunk's first top-level particle
+    std::uint64_t rowCount;        // Top-level particles in the chunk
+    std::uint64_t imageSize;       // Bytes of the image, without padding
+    std::uint64_t imageChecksum;
+    std::uint64_t headerChecksum;  // Of the fields above
+};
+
+static_assert(std::is_trivially_copyable<CheckpointChunkHeader>::value && sizeof(CheckpointChunkHeader) == 48,
+              "CheckpointChunkHeader layout is part of the file format");
+
+// Periodic, incremental persistence of a ParticleCatalogue that only grows between
+// checkpoints. checkpoint() encodes just the rows added since the previous call, as chunks
+// built in parallel, and appends them to the log; restore() replays the log into a
+// catalogue, verifying and decoding chunks in parallel.
+//
+// Rows are identified by position: sorting or clearing the catalogue invalidates the log,
+// and a new log must be started. Decay products are stored with their parents; a product
+// that is also catalogued in a different chunk is restored as a separate copy.
+class CatalogueCheckpoint {
+public:
+    struct Config {
+        std::size_t chunkRows = 65536;  // Top-level particles per chunk
+        unsigned threads = 0;           // Encoding threads; 0 selects the hardware concurrency
+        bool sync = true;               // Flush to stable storage before checkpoint() returns
+    };
+
+    struct RestoreSummary {
+        std::size_t chunks = 0;
+        std::size_t rows = 0;            // Top-level particles added to the catalogue
+        std::size_t discardedBytes = 0;  // Invalid tail of the log, from a torn or damaged chunk
+    };
+
+    static constexpr char magic[8] = {'P', 'C', 'C', 'H', 'U', 'N', 'K', '1'};
+
+    // Opens the log at path, creating it if needed. The rows of an existing log count as
+    // persisted, and an invalid tail left by a crash is truncated so appends continue after
+    // the last good chunk.
+    explicit CatalogueCheckpoint(std::string path) : CatalogueCheckpoint(std::move(path), Config()) {}
+    CatalogueCheckpoint(std::string path, Config config);
+    ~CatalogueCheckpoint();
+
+    CatalogueCheckpoint(const CatalogueCheckpoint&) = delete;
+    CatalogueCheckpoint& operator=(const CatalogueCheckpoint&) = delete;
+
+    // Appends catalogue rows [persistedRows(), size); returns the number of rows written.
+    // On a write or sync failure the log is truncated back to its last good chunk before
+    // std::runtime_error is thrown, so a later checkpoint() retries the same rows. If even
+    // that fails the object is marked failed and every later checkpoint() throws.
+    std::size_t checkpoint(const ParticleCatalogue& catalogue);
+
+    std::size_t persistedRows() const { return persistedRows_; }
+    std::size_t chunkCount() const { return chunkCount_; }
+    bool failed() const { return failed_; }
+    const std::string& getPath() const { return path_; }
+
+    // Adds the rows of every valid chunk to catalogue, under its validation policy, in row
+    // order. Stops at the first invalid chunk.
+    static RestoreSummary restore(const std::string& path, ParticleCatalogue& catalogue, unsigned threads = 0);
+
+    // xxHash64-style checksum used for the chunks
+    static std::uint64_t checksum(const void* data, std::size_t size);
+
+private:
+    std::string path_;
+    Config config_;
+    ParallelExecutor executor_;
+    std::FILE* file_ = nullptr;
+    std::size_t persistedRows_ = 0;
+    std::size_t chunkCount_ = 0;
+    std::uint64_t validBytes_ = 0;  // End of the last good chunk
+    bool failed_ = false;
+
+    // Drops whatever a failed checkpoint() appended after validBytes_, then throws
+    [[noreturn]] void rollBack(const char* what);
+};
+
+#endif // CATALOGUE_CHECKPOINT_H
@@ -0,0 +1,331 @@
+#include "CatalogueExporter.h"
+#include "Boson.h"
+#include "Lepton.h"
+#include "ParallelExecutor.h"
+#include "ParticleCatalogue.h"
+#include "Quark.h"
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <fstream>
+#include <ostream>
+#include <stdexcept>
+#include <string_view>
+#include <typeinfo>
+
+namespace {
+
+constexpr std::string_view separator = "----------------------------------------------------------------\n";
+
+// Large enough for any double in fixed notation with the precisions used here
+constexpr std::size_t numberBufferSize = 512;
+
+void appendFixed(std::string& out, double value, int precision) {
+    char buffer[numberBufferSize];
+    auto result = std::to_chars(buffer, buffer + numberBufferSize, value, std::chars_format::fixed, precision);
+    out.append(buffer, result.ptr);
+}
+
+// Shortest representation that reads back to the same double
+void appendShortest(std::string& out, double value) {
+    char buffer[numberBufferSize];
+    auto result = std::to_chars(buffer, buffer + numberBufferSize, value);
+    out.append(buffer, result.ptr);
+}
+
+void appendInt(std::string& out, long long value) {
+    char buffer[24];
+    auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+    out.append(buffer, result.ptr);
+}
+
+void appendCsvField(std::string& out, std::string_view field) {
+    if (field.find_first_of(",\"\r\n") == std::string_view::npos) {
+        out.append(field);
+        return;
+    }
+    out.push_back('"');
+    for (char c : field) {
+        if (c == '"') out.push_back('"');
+        out.push_back(c);
+    }
+    out.push_back('"');
+}
+
+void appendJsonString(std::string& out, std::string_view text) {
+    static constexpr char hex[] = "0123456789abcdef";
+    out.push_back('"');
+    for (char c : text) {
+        unsigned char u = static_cast<unsigned char>(c);
+        if (c == '"' || c == '\\') {
+            out.push_back('\\');
+            out.push_back(c);
+        } else if (u < 0x20) {
+            out.append("\\u00");
+            out.push_back(hex[u >> 4]);
+            out.push_back(hex[u & 0xF]);
+        } else {
+            out.push_back(c);
+        }
+    }
+    out.push_back('"');
+}
+
+// JSON has no literal for infinities or NaN
+void appendJsonNumber(std::string& out, double value) {
+    if (std::isfinite(value)) {
+        appendShortest(out, value);
+    } else {
+        out.append("null");
+    }
+}
+
+void appendFourMomentum(std::string& out, const FourMomentum& p, int precision) {
+    out.append("Four-momentum  : (E=");
+    appendFixed(out, p.getComponent(0), precision);
+    out.append(", px=");
+    appendFixed(out, p.getComponent(1), precision);
+    out.append(", py=");
+    appendFixed(out, p.getComponent(2), precision);
+    out.append(", pz=");
+    appendFixed(out, p.getComponent(3), precision);
+    out.append(")\n");
+}
+
+void appendText(std::string& out, const Particle& particle, bool detailed);
+
+// The appenders below mirror the print functions of Quark.h, Lepton.h and Boson.h,
+// including the precision each of them leaves on the stream.
+void appendQuark(std::string& out, const Quark& quark, bool detailed) {
+    out.append("Particle Type  : ").append(quark.getType()).append("\nCharge         : ");
+    appendFixed(out, quark.charge(), 3);
+    out.append("\nSpin           : ");
+    appendFixed(out, quark.spin(), 3);
+    out.append("\nColor Charge   : ").append(quark.getColorCharge()).append("\n");
+    appendFourMomentum(out, quark.getFourMomentum(), 3);
+    if (detailed) {
+        const auto& products = quark.getDecayProducts();
+        if (products.empty()) {
+            out.append("No decay products listed.\n");
+        } else {
+            out.append("Decays into:\n");
+            for (const auto& product : products) appendText(out, *product, false);
+        }
+    }
+}
+
+void appendDecayTypes(std::string& out, const std::vector<std::shared_ptr<Particle>>& products) {
+    out.append("Decays into    : ");
+    for (const auto& product : products) out.append(product->getType()).append(" ");
+    out.append("\n");
+}
+
+void appendLepton(std::string& out, const Lepton& lepton, const std::vector<std::shared_ptr<Particle>>& products, bool detailed) {
+    out.append(separator).append("Particle Type  : ").append(lepton.getType()).append("\nCharge         : ");
+    appendFixed(out, lepton.charge(), 2);
+    out.append("\nSpin           : ");
+    appendFixed(out, lepton.spin(), 2);
+    out.append("\nLepton Number  : ");
+    appendInt(out, lepton.getLeptonNumber());
+    out.append("\n");
+    appendFourMomentum(out, lepton.getFourMomentum(), 2);
+    if (detailed && !products.empty()) appendDecayTypes(out, products);
+    out.append(separator);
+}
+
+void appendBoson(std::string& out, const Boson& boson, bool detailed) {
+    FourMomentum p = boson.getFourMomentum();
+    out.append(separator).append("Particle Type  : ").append(boson.getType()).append("\nCharge         : ");
+    appendFixed(out, boson.charge(), 2);
+    out.append("\nSpin           : ");
+    appendFixed(out, boson.spin(), 2);
+    out.append("\n");
+    appendFourMomentum(out, p, 2);
+    out.append("Derived Mass   : ");
+    appendFixed(out, p.invariantMass(), 2);
+    out.append(" MeV\n");
+    const auto& products = boson.getDecayProducts();
+    if (detailed && !products.empty()) {
+        out.append("Decays into    : ");
+        for (const auto& product : products) {
+            out.append(product->getType()).append(" (");
+            appendFixed(out, product->getFourMomentum().invariantMass(), 2);
+            out.append(" MeV) ");
+        }
+        out.append("\n");
+    }
+    out.append(separator);
+}
+
+void appendGeneric(std::string& out, const Particle& particle) {
+    out.append(separator).append("Particle Type  : ").append(particle.getType()).append("\nCharge         : ");
+    appendFixed(out, particle.charge(), 2);
+    out.append("\nSpin           : ");
+    appendFixed(out, particle.spin(), 2);
+    out.append("\n");
+    appendFourMomentum(out, particle.getFourMomentum(), 2);
+    out.append(separator);
+}
+
+// Dispatches on the exact dynamic class, since a subclass may override print
+void appendText(std::string& out, const Particle& particle, bool detailed) {
+    const std::type_info& type = typeid(particle);
+    if (type == typeid(Quark)) {
+        appendQuark(out, static_cast<const Quark&>(particle), detailed);
+    } else if (type == typeid(Boson)) {
+        appendBoson(out, static_cast<const Boson&>(particle), detailed);
+    } else if (type == typeid(Tau)) {
+        // Tau::print lists its decay products a second time after Lepton::print
+        const Tau& tau = static_cast<const Tau&>(particle);
+        appendLepton(out, tau, tau.getDecayProducts(), detailed);
+        if (detailed && !tau.getDecayProducts().empty()) appendDecayTypes(out, tau.getDecayProducts());
+    } else if (type == typeid(Lepton) || type == typeid(Electron) || type == typeid(Muon) || type == typeid(Neutrino)) {
+        appendLepton(out, static_cast<const Lepton&>(particle), {}, detailed);
+    } else {
+        appendGeneric(out, particle);
+    }
+}
+
+// Initial buffer capacity per row, so a shard rarely reallocates
+std::size_t bytesPerRow(ExportFormat format) {
+    switch (format) {
+    case ExportFormat::Csv: return 128;
+    case ExportFormat::JsonLines: return 224;
+    case ExportFormat::Text: return 384;
+    }
+    return 256;
+}
+
+} // namespace
+
+bool CatalogueExporter::hasTextLayout(const Particle& particle) {
+    const std::type_info& type = typeid(particle);
+    return type == typeid(Quark) || type == typeid(Boson) || type == typeid(Lepton) || type == typeid(Electron) ||
+           type == typeid(Muon) || type == typeid(Tau) || type == typeid(Neutrino);
+}
+
+void CatalogueExporter::format(const ParticleCatalogue& catalogue, std::size_t begin, std::size_t end, std::string& out) const {
+    const ParticleColumns& columns = catalogue.getColumns();
+    if (begin > end || end > columns.size()) {
+        throw std::out_of_range("Row range out of bounds in CatalogueExporter::format.");
+    }
+    if (config_.format == ExportFormat::Text) {
+        const auto& particles = catalogue.getParticles();
+        for (std::size_t i = begin; i < end; i++) {
+            if (particles[i]) appendText(out, *particles[i], config_.detailed);
+        }
+        return;
+    }
+
+    const double* E = columns.energy().data();
+    const double* px = columns.px().data();
+    const double* py = columns.py().data();
+    const double* pz = columns.pz().data();
+    const double* charge = columns.charge().data();
+    const double* spin = columns.spin().data();
+    const int* lepton = columns.leptonNumber().data();
+    const int* baryon = columns.baryonNumber().data();
+    const std::uint16_t* typeId = columns.typeId().data();
+
+    if (config_.format == ExportFormat::Csv) {
+        for (std::size_t i = begin; i < end; i++) {
+            appendCsvField(out, columns.typeName(typeId[i]));
+            out.push_back(',');
+            appendShortest(out, E[i]);
+            out.push_back(',');
+            appendShortest(out, px[i]);
+            out.push_back(',');
+            appendShortest(out, py[i]);
+            out.push_back(',');
+            appendShortest(out, pz[i]);
+            out.push_back(',');
+            appendShortest(out, charge[i]);
+            out.push_back(',');
+            appendShortest(out, spin[i]);
+            out.push_back(',');
+            appendInt(out, lepton[i]);
+            out.push_back(',');
+            appendInt(out, baryon[i]);
+            out.push_back('\n');
+        }
+    } else {
+        for (std::size_t i = begin; i < end; i++) {
+            out.append("{\"type\":");
+            appendJsonString(out, columns.typeName(typeId[i]));
+            out.append(",\"E\":");
+            appendJsonNumber(out, E[i]);
+            out.append(",\"px\":");
+            appendJsonNumber(out, px[i]);
+            out.append(",\"py\":");
+            appendJsonNumber(out, py[i]);
+            out.append(",\"pz\":");
+            appendJsonNumber(out, pz[i]);
+            out.append(",\"charge\":");
+            appendJsonNumber(out, charge[i]);
+            out.append(",\"spin\":");
+            appendJsonNumber(out, spin[i]);
+            out.append(",\"leptonNumber\":");
+            appendInt(out, lepton[i]);
+            out.append(",\"baryonNumber\":");
+            appendInt(out, baryon[i]);
+            out.append("}\n");
+        }
+    }
+}
+
+void CatalogueExporter::write(const ParticleCatalogue& catalogue, std::size_t begin, std::size_t end, const Sink& sink) const {
+    if (begin > end || end > catalogue.getColumns().size()) {
+        throw std::out_of_range("Row range out of bounds in CatalogueExporter::write.");
+    }
+    if (config_.format == ExportFormat::Csv && config_.header) {
+        static constexpr std::string_view header = "type,E,px,py,pz,charge,spin,leptonNumber,baryonNumber\n";
+        sink(header.data(), header.size());
+    }
+
+    const std::size_t shardSize = std::max<std::size_t>(1, config_.shardSize);
+    const std::size_t shards = ParallelExecutor::blockCount(end - begin, shardSize);
+    ParallelExecutor executor(config_.threads);
+    // Two shards per thread keep the workers busy while bounding the memory held in buffers
+    const std::size_t wave = executor.getThreadCount() == 1 ? 1 : 2 * static_cast<std::size_t>(executor.getThreadCount());
+    std::vector<std::string> buffers(std::min(wave, shards));
+
+    for (std::size_t first = 0; first < shards; first += wave) {
+        const std::size_t count = std::min(wave, shards - first);
+        executor.forEachBlock(count, [&](std::size_t i) {
+            std::size_t rowBegin = begin + (first + i) * shardSize;
+            std::size_t rowEnd = std::min(end, rowBegin + shardSize);
+            std::string& buffer = buffers[i];
+            buffer.clear();
+            buffer.reserve((rowEnd - rowBegin) * bytesPerRow(config_.format));
+            format(catalogue, rowBegin, rowEnd, buffer);
+        });
+        for (std::size_t i = 0; i < count; i++) {
+            sink(buffers[i].data(), buffers[i].size());
+        }
+    }
+}
+
+void CatalogueExporter::write(const ParticleCatalogue& catalogue, const Sink& sink) const {
+    write(catalogue, 0, catalogue.getColumns().size(), sink);
+}
+
+void CatalogueExporter::write(const ParticleCatalogue& catalogue, std::ostream& out) const {
+    write(catalogue, [&out](const char* data, std::size_t size) {
+        out.write(data, static_cast<std::streamsize>(size));
+    });
+    if (!out) {
+        throw std::runtime_error("Failed to write catalogue export.");
+    }
+}
+
+void CatalogueExporter::write(const ParticleCatalogue& catalogue, const std::string& path) const {
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        throw std::runtime_error("Cannot open export file for writing: " + path);
+    }
+    write(catalogue, out);
+    out.flush();
+    if (!out) {
+        throw std::runtime_error("Failed to write export file: " + path);
+    }
+}
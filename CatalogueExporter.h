@@ -0,0 +1,58 @@
+#ifndef CATALOGUE_EXPORTER_H
+#define CATALOGUE_EXPORTER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iosfwd>
+#include <string>
+
+class Particle;
+class ParticleCatalogue;
+
+// Csv       - "type,E,px,py,pz,charge,spin,leptonNumber,baryonNumber", readable by EventStreamPipeline
+// JsonLines - one object per particle with the same fields
+// Text      - the layout of Particle::print, byte for byte for the library particle classes
+enum class ExportFormat : std::uint8_t { Csv, JsonLines, Text };
+
+// Bulk writer for catalogue contents. Rows are formatted shard by shard into large buffers
+// with std::to_chars, and each full buffer is handed to the sink in one call. With several
+// threads a wave of shards is formatted in parallel and then written in row order, so the
+// output is identical whatever the thread count.
+class CatalogueExporter {
+public:
+    struct Config {
+        ExportFormat format = ExportFormat::Csv;
+        bool header = true;              // Csv: write the header row
+        bool detailed = false;           // Text: as print(true), with decay products
+        unsigned threads = 1;            // 0 selects the hardware concurrency
+        std::size_t shardSize = 16384;   // Rows formatted into one buffer
+    };
+
+    // Receives consecutive pieces of the output
+    using Sink = std::function<void(const char* data, std::size_t size)>;
+
+    CatalogueExporter() = default;
+    explicit CatalogueExporter(Config config) : config_(config) {}
+
+    const Config& getConfig() const { return config_; }
+
+    void write(const ParticleCatalogue& catalogue, const Sink& sink) const;
+    void write(const ParticleCatalogue& catalogue, std::ostream& out) const;
+    void write(const ParticleCatalogue& catalogue, const std::string& path) const;
+
+    // Rows [begin, end) only; the Csv header is still written when configured
+    void write(const ParticleCatalogue& catalogue, std::size_t begin, std::size_t end, const Sink& sink) const;
+
+    // Appends rows [begin, end) to out, without a header
+    void format(const ParticleCatalogue& catalogue, std::size_t begin, std::size_t end, std::string& out) const;
+
+    // True when the Text format reproduces particle.print exactly; other classes get a
+    // generic block with type, charge, spin and four-momentum
+    static bool hasTextLayout(const Particle& particle);
+
+private:
+    Config config_;
+};
+
+#endif // CATALOGUE_EXPORTER_H
@@ -0,0 +1,484 @@
+#include "CatalogueFile.h"
+#include "Quark.h"
+#include "Lepton.h"
+#include "Boson.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+#include <unordered_map>
+#include <utility>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+constexpr char CatalogueFile::magic[8];
+
+namespace {
+
+constexpr std::uint64_t alignTo8(std::uint64_t offset) {
+    return (offset + 7) & ~std::uint64_t{7};
+}
+
+std::uint32_t checkedIndex(std::size_t value) {
+    if (value > std::numeric_limits<std::uint32_t>::max() - 1) {
+        throw std::length_error("Catalogue too large for the version 1 file format.");
+    }
+    return static_cast<std::uint32_t>(value);
+}
+
+ParticleKind kindOf(const Particle& particle) {
+    if (dynamic_cast<const Electron*>(&particle)) return ParticleKind::Electron;
+    if (dynamic_cast<const Muon*>(&particle)) return ParticleKind::Muon;
+    if (dynamic_cast<const Tau*>(&particle)) return ParticleKind::Tau;
+    if (dynamic_cast<const Neutrino*>(&particle)) return ParticleKind::Neutrino;
+    if (dynamic_cast<const Lepton*>(&particle)) return ParticleKind::Lepton;
+    if (dynamic_cast<const Quark*>(&particle)) return ParticleKind::Quark;
+    if (dynamic_cast<const Boson*>(&particle)) return ParticleKind::Boson;
+    throw std::invalid_argument("Unsupported particle class for the catalogue file format: " + std::string(particle.getType()));
+}
+
+// Collects records and their side tables; decay products are appended breadth-first
+// after the top-level particles and shared products are written once.
+//
+// Given the catalogue's columns, top-level records are filled from them: numbers come from
+// the columns, the type name is interned once per type id and the kind is resolved once per
+// dynamic class, so the common row costs no string hashing and no dynamic_cast.
+class Encoder {
+private:
+    const ParticleColumns* columns_;
+    std::size_t firstRow_ = 0;
+    std::vector<ParticleRecord> records_;
+    std::vector<const Particle*> sources_;
+    std::vector<double> layers_;
+    std::vector<std::uint32_t> links_;
+    std::string strings_;
+    std::unordered_map<std::string, std::uint32_t> stringOffsets_;
+    std::unordered_map<const Particle*, std::uint32_t> recordIndex_;  // Nested products only
+    std::vector<std::pair<const Particle*, std::uint32_t>> topLevelIndex_;  // Sorted on first lookup
+    std::size_t topLevelCount_ = 0;
+    static constexpr std::uint32_t noRecord = 0xFFFFFFFFu;
+    std::vector<std::uint32_t> typeNames_;    // String table offset by column type id
+    std::vector<ParticleKind> classKinds_;    // By column class id
+    std::vector<unsigned char> classKnown_;
+    std::vector<std::pair<std::string, std::uint32_t>> colours_;  // The first few colour charges seen
+
+    std::uint32_t internColour(const std::string& colour) {
+        for (const auto& entry : colours_) {
+            if (entry.first == colour) return entry.second;
+        }
+        std::uint32_t offset = intern(colour);
+        if (colours_.size() < 16) colours_.emplace_back(colour, offset);
+        return offset;
+    }
+
+    std::uint32_t intern(std::string key) {
+        auto it = stringOffsets_.find(key);
+        if (it != stringOffsets_.end()) return it->second;
+        std::uint32_t offset = checkedIndex(strings_.size());
+        strings_.append(key);
+        strings_.push_back('\0');
+        stringOffsets_.emplace(std::move(key), offset);
+        return offset;
+    }
+
+    std::uint32_t internType(std::uint16_t type) {
+        if (type >= typeNames_.size()) typeNames_.resize(type + 1, ParticleRecord::noString);
+        if (typeNames_[type] == ParticleRecord::noString) typeNames_[type] = intern(std::string(columns_->typeName(type)));
+        return typeNames_[type];
+    }
+
+    ParticleKind classKind(std::uint16_t classId, const Particle& particle) {
+        if (classId >= classKinds_.size()) {
+            classKinds_.resize(classId + 1);
+            classKnown_.resize(classId + 1, 0);
+        }
+        if (!classKnown_[classId]) {
+            classKinds_[classId] = kindOf(particle);
+            classKnown_[classId] = 1;
+        }
+        return classKinds_[classId];
+    }
+
+    // Most chunks have few decay products, so top-level rows are indexed only once a product
+    // needs looking up, and then as a sorted array rather than one hash insert per row
+    std::uint32_t findTopLevel(const Particle* particle) {
+        if (topLevelIndex_.empty() && topLevelCount_ > 0) {
+            topLevelIndex_.reserve(topLevelCount_);
+            for (std::size_t i = 0; i < topLevelCount_; i++) topLevelIndex_.emplace_back(sources_[i], static_cast<std::uint32_t>(i));
+            std::sort(topLevelIndex_.begin(), topLevelIndex_.end());
+        }
+        auto it = std::lower_bound(topLevelIndex_.begin(), topLevelIndex_.end(), std::make_pair(particle, std::uint32_t{0}));
+        return it != topLevelIndex_.end() && it->first == particle ? it->second : noRecord;
+    }
+
+    std::uint32_t addRecord(const Particle* particle, bool topLevel) {
+        if (!topLevel) {
+            std::uint32_t found = findTopLevel(particle);
+            if (found != noRecord) return found;
+            auto it = recordIndex_.find(particle);
+            if (it != recordIndex_.end()) return it->second;
+        }
+        std::uint32_t index = checkedIndex(records_.size());
+        if (!topLevel) recordIndex_.emplace(particle, index);
+        ParticleRecord record{};
+        record.flags = topLevel ? ParticleRecord::TopLevel : 0;
+        records_.push_back(record);
+        sources_.push_back(particle);
+        return index;
+    }
+
+    void fill(std::size_t index) {
+        const Particle& particle = *sources_[index];
+        ParticleRecord& record = records_[index];
+        if (columns_ && (record.flags & ParticleRecord::TopLevel)) {
+            std::size_t row = firstRow_ + index;
+            record.E = columns_->energy()[row];
+            record.px = columns_->px()[row];
+            record.py = columns_->py()[row];
+            record.pz = columns_->pz()[row];
+            record.charge = columns_->charge()[row];
+            record.spin = columns_->spin()[row];
+            record.leptonNumber = columns_->leptonNumber()[row];
+            record.baryonNumber = columns_->baryonNumber()[row];
+            record.kind = classKind(columns_->classId()[row], particle);
+            record.typeName = internType(columns_->typeId()[row]);
+        } else {
+            FourMomentum p = particle.getFourMomentum();
+            record.E = p.data()[0];
+            record.px = p.data()[1];
+            record.py = p.data()[2];
+            record.pz = p.data()[3];
+            record.charge = particle.charge();
+            record.spin = particle.spin();
+            record.leptonNumber = particle.getLeptonNumber();
+            record.baryonNumber = particle.getBaryonNumber();
+            record.kind = kindOf(particle);
+            record.typeName = intern(std::string(particle.getType()));
+        }
+        record.colourCharge = ParticleRecord::noString;
+        if (particle.isIsolated()) record.flags |= ParticleRecord::Isolated;
+        if (particle.hasInteracted()) record.flags |= ParticleRecord::Interacted;
+
+        switch (record.kind) {
+            case ParticleKind::Quark:
+                record.colourCharge = internColour(static_cast<const Quark&>(particle).getColorCharge());
+                break;
+            case ParticleKind::Electron: {
+                CalorimeterLayers layers = static_cast<const Electron&>(particle).getCalorimeterLayers();
+                record.layerBegin = checkedIndex(layers_.size());
+                record.layerCount = checkedIndex(layers.size());
+                layers_.insert(layers_.end(), layers.begin(), layers.end());
+                break;
+            }
+            default:
+                break;
+        }
+        const std::vector<std::shared_ptr<Particle>>& products = particle.getDecayProducts();
+
+        // Index through records_ again afterwards: addRecord may reallocate it
+        std::uint32_t linkBegin = checkedIndex(links_.size());
+        for (const auto& product : products) {
+            if (product) links_.push_back(addRecord(product.get(), false));
+        }
+        records_[index].linkBegin = linkBegin;
+        records_[index].linkCount = checkedIndex(links_.size() - linkBegin);
+    }
+
+public:
+    // columns, when given, mirror particles row for row and must not contain null rows
+    explicit Encoder(const ParticleColumns* columns = nullptr) : columns_(columns) {}
+
+    std::vector<std::byte> encode(const std::vector<std::shared_ptr<Particle>>& particles, std::size_t begin, std::size_t end) {
+        firstRow_ = begin;
+        records_.reserve(end - begin);
+        sources_.reserve(end - begin);
+        for (std::size_t i = begin; i < end; i++) {
+            if (particles[i]) addRecord(particles[i].get(), true);
+        }
+        std::size_t topLevel = topLevelCount_ = records_.size();
+        for (std::size_t i = 0; i < records_.size(); i++) {
+            fill(i);
+        }
+
+        CatalogueFileHeader header{};
+        std::memcpy(header.magic, CatalogueFile::magic, sizeof(header.magic));
+        header.version = CatalogueFile::version;
+        header.recordSize = sizeof(ParticleRecord);
+        header.recordCount = records_.size();
+        header.topLevelCount = topLevel;
+        header.recordOffset = alignTo8(sizeof(CatalogueFileHeader));
+        header.layerOffset = alignTo8(header.recordOffset + records_.size() * sizeof(ParticleRecord));
+        header.layerCount = layers_.size();
+        header.linkOffset = alignTo8(header.layerOffset + layers_.size() * sizeof(double));
+        header.linkCount = links_.size();
+        header.stringTableOffset = alignTo8(header.linkOffset + links_.size() * sizeof(std::uint32_t));
+        header.stringTableSize = strings_.size();
+
+        std::vector<std::byte> image(static_cast<std::size_t>(header.stringTableOffset + header.stringTableSize));
+        std::memcpy(image.data(), &header, sizeof(header));
+        if (!records_.empty()) std::memcpy(image.data() + header.recordOffset, records_.data(), records_.size() * sizeof(ParticleRecord));
+        if (!layers_.empty()) std::memcpy(image.data() + header.layerOffset, layers_.data(), layers_.size() * sizeof(double));
+        if (!links_.empty()) std::memcpy(image.data() + header.linkOffset, links_.data(), links_.size() * sizeof(std::uint32_t));
+        if (!strings_.empty()) std::memcpy(image.data() + header.stringTableOffset, strings_.data(), strings_.size());
+        return image;
+    }
+};
+
+bool sectionFits(std::uint64_t offset, std::uint64_t count, std::uint64_t elementSize, std::size_t total) {
+    if (offset > total) return false;
+    return count <= (total - offset) / elementSize;
+}
+
+} // namespace
+
+std::vector<std::byte> CatalogueFile::encode(const std::vector<std::shared_ptr<Particle>>& particles, std::size_t begin, std::size_t end) {
+    return Encoder().encode(particles, begin, end);
+}
+
+std::vector<std::byte> CatalogueFile::encode(const ParticleCatalogue& catalogue, std::size_t begin, std::size_t end) {
+    return Encoder(&catalogue.getColumns()).encode(catalogue.getParticles(), begin, end);
+}
+
+void CatalogueFile::write(const ParticleCatalogue& catalogue, const std::string& path) {
+    std::vector<std::byte> image = encode(catalogue, 0, catalogue.getTotalNumberOfParticles());
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        throw std::runtime_error("Cannot open catalogue file for writing: " + path);
+    }
+    out.write(reinterpret_cast<const char*>(image.data()), static_cast<std::streamsize>(image.size()));
+    if (!out) {
+        throw std::runtime_error("Failed to write catalogue file: " + path);
+    }
+}
+
+void CatalogueImage::attach(const std::byte* data, std::size_t size) {
+    if (size < sizeof(CatalogueFileHeader) || reinterpret_cast<std::uintptr_t>(data) % alignof(std::uint64_t) != 0) {
+        throw std::runtime_error("Catalogue image is truncated or misaligned.");
+    }
+    const auto* header = reinterpret_cast<const CatalogueFileHeader*>(data);
+    if (std::memcmp(header->magic, CatalogueFile::magic, sizeof(header->magic)) != 0) {
+        throw std::runtime_error("Not a particle catalogue file.");
+    }
+    if (header->version != CatalogueFile::version || header->recordSize != sizeof(ParticleRecord)) {
+        throw std::runtime_error("Unsupported catalogue file version " + std::to_string(header->version) + ".");
+    }
+    if (header->topLevelCount > header->recordCount ||
+        header->recordOffset % 8 != 0 || header->layerOffset % 8 != 0 || header->linkOffset % 4 != 0 ||
+        !sectionFits(header->recordOffset, header->recordCount, sizeof(ParticleRecord), size) ||
+        !sectionFits(header->layerOffset, header->layerCount, sizeof(double), size) ||
+        !sectionFits(header->linkOffset, header->linkCount, sizeof(std::uint32_t), size) ||
+        !sectionFits(header->stringTableOffset, header->stringTableSize, 1, size)) {
+        throw std::runtime_error("Catalogue file sections are out of bounds.");
+    }
+    header_ = header;
+    records_ = reinterpret_cast<const ParticleRecord*>(data + header->recordOffset);
+    layers_ = reinterpret_cast<const double*>(data + header->layerOffset);
+    links_ = reinterpret_cast<const std::uint32_t*>(data + header->linkOffset);
+    strings_ = reinterpret_cast<const char*>(data + header->stringTableOffset);
+}
+
+const ParticleRecord& CatalogueImage::record(std::size_t index) const {
+    if (index >= size()) {
+        throw std::out_of_range("Record index out of range in CatalogueImage::record.");
+    }
+    return records_[index];
+}
+
+std::string_view CatalogueImage::stringAt(std::uint32_t offset) const {
+    if (offset >= header_->stringTableSize) {
+        throw std::runtime_error("Corrupt string reference in catalogue file.");
+    }
+    const char* begin = strings_ + offset;
+    const void* terminator = std::memchr(begin, '\0', static_cast<std::size_t>(header_->stringTableSize - offset));
+    if (!terminator) {
+        throw std::runtime_error("Unterminated string in catalogue file.");
+    }
+    return std::string_view(begin, static_cast<std::size_t>(static_cast<const char*>(terminator) - begin));
+}
+
+std::string_view CatalogueImage::typeName(const ParticleRecord& record) const {
+    return stringAt(record.typeName);
+}
+
+std::string_view CatalogueImage::colourCharge(const ParticleRecord& record) const {
+    if (record.colourCharge == ParticleRecord::noString) return {};
+    return stringAt(record.colourCharge);
+}
+
+CatalogueImage::Span<double> CatalogueImage::calorimeterLayers(const ParticleRecord& record) const {
+    if (!sectionFits(record.layerBegin, record.layerCount, 1, static_cast<std::size_t>(header_->layerCount))) {
+        throw std::runtime_error("Corrupt calorimeter layer reference in catalogue file.");
+    }
+    return {layers_ + record.layerBegin, record.layerCount};
+}
+
+CatalogueImage::Span<std::uint32_t> CatalogueImage::decayProducts(const ParticleRecord& record) const {
+    if (!sectionFits(record.linkBegin, record.linkCount, 1, static_cast<std::size_t>(header_->linkCount))) {
+        throw std::runtime_error("Corrupt decay link reference in catalogue file.");
+    }
+    return {links_ + record.linkBegin, record.linkCount};
+}
+
+std::shared_ptr<Particle> CatalogueImage::materialize(std::size_t index) const {
+    std::unordered_map<std::size_t, std::shared_ptr<Particle>> cache;
+    return materialize(index, cache, 0);
+}
+
+std::shared_ptr<Particle> CatalogueImage::materialize(std::size_t index, std::unordered_map<std::size_t, std::shared_ptr<Particle>>& cache, int depth) const {
+    auto cached = cache.find(index);
+    if (cached != cache.end()) return cached->second;
+    if (depth > 256) {
+        throw std::runtime_error("Decay chain too deep in catalogue file (cyclic links?).");
+    }
+
+    const ParticleRecord& rec = record(index);
+    FourMomentum p = fourMomentum(rec);
+    std::shared_ptr<Particle> particle;
+    switch (rec.kind) {
+        case ParticleKind::Quark:
+            particle = std::make_shared<Quark>(std::string(typeName(rec)), rec.charge, rec.spin, std::string(colourCharge(rec)), p);
+            break;
+        case ParticleKind::Lepton:
+            particle = std::make_shared<Lepton>(rec.charge, rec.spin, rec.leptonNumber, p);
+            break;
+        case ParticleKind::Electron: {
+            Span<double> layers = calorimeterLayers(rec);
+            particle = std::make_shared<Electron>(rec.charge, rec.spin, p, std::vector<double>(layers.begin(), layers.end()));
+            break;
+        }
+        case ParticleKind::Muon:
+            particle = std::make_shared<Muon>(rec.charge, rec.spin, p, (rec.flags & ParticleRecord::Isolated) != 0);
+            break;
+        case ParticleKind::Tau:
+            particle = std::make_shared<Tau>(rec.charge, rec.spin, p);
+            break;
+        case ParticleKind::Neutrino:
+            particle = std::make_shared<Neutrino>(rec.charge, rec.spin, rec.leptonNumber, p);
+            break;
+        case ParticleKind::Boson:
+            particle = std::make_shared<Boson>(std::string(typeName(rec)), rec.charge, rec.spin, p);
+            break;
+        default:
+            throw std::runtime_error("Unknown particle kind in catalogue file.");
+    }
+    cache.emplace(index, particle);
+
+    Span<std::uint32_t> links = decayProducts(rec);
+    std::vector<std::shared_ptr<Particle>> products;
+    for (std::uint32_t link : links) {
+        products.push_back(materialize(link, cache, depth + 1));
+    }
+    if (!products.empty()) {
+        switch (rec.kind) {
+            case ParticleKind::Quark:
+                for (const auto& product : products) static_cast<Quark&>(*particle).addDecayProduct(product);
+                break;
+            case ParticleKind::Boson:
+                for (const auto& product : products) static_cast<Boson&>(*particle).addDecayProduct(product);
+                break;
+            case ParticleKind::Tau:
+                static_cast<Tau&>(*particle).setDecayProducts(products);
+                break;
+            default:
+                break;  // The other classes cannot hold decay products
+        }
+    }
+    return particle;
+}
+
+std::vector<std::shared_ptr<Particle>> CatalogueImage::materializeTopLevel() const {
+    std::unordered_map<std::size_t, std::shared_ptr<Particle>> cache;
+    std::vector<std::shared_ptr<Particle>> particles;
+    particles.reserve(topLevelCount());
+    for (std::size_t i = 0; i < topLevelCount(); i++) {
+        particles.push_back(materialize(i, cache, 0));
+    }
+    return particles;
+}
+
+void CatalogueImage::loadInto(ParticleCatalogue& catalogue) const {
+    ValidationScope scope = catalogue.validationScope();
+    std::unordered_map<std::size_t, std::shared_ptr<Particle>> cache;
+    catalogue.reserve(catalogue.getTotalNumberOfParticles() + topLevelCount());
+    for (std::size_t i = 0; i < topLevelCount(); i++) {
+        catalogue.addParticle(materialize(i, cache, 0));
+    }
+}
+
+MappedCatalogue::MappedCatalogue(const std::string& path) {
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        throw std::runtime_error("Cannot open catalogue file: " + path);
+    }
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0) {
+        CloseHandle(file);
+        throw std::runtime_error("Cannot map empty catalogue file: " + path);
+    }
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    void* view = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+    if (!view) {
+        if (mapping) CloseHandle(mapping);
+        CloseHandle(file);
+        throw std::runtime_error("Cannot memory-map catalogue file: " + path);
+    }
+    fileHandle_ = file;
+    mappingHandle_ = mapping;
+    mapping_ = view;
+    mappedSize_ = static_cast<std::size_t>(fileSize.QuadPart);
+#else
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("Cannot open catalogue file: " + path);
+    }
+    struct stat info;
+    if (::fstat(fd, &info) != 0 || info.st_size == 0) {
+        ::close(fd);
+        throw std::runtime_error("Cannot map empty catalogue file: " + path);
+    }
+    void* view = ::mmap(nullptr, static_cast<std::size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);  // The mapping keeps the file alive
+    if (view == MAP_FAILED) {
+        throw std::runtime_error("Cannot memory-map catalogue file: " + path);
+    }
+    mapping_ = view;
+    mappedSize_ = static_cast<std::size_t>(info.st_size);
+#endif
+    try {
+        attach(static_cast<const std::byte*>(mapping_), mappedSize_);
+    } catch (...) {
+        unmap();
+        throw;
+    }
+}
+
+MappedCatalogue::~MappedCatalogue() {
+    unmap();
+}
+
+void MappedCatalogue::unmap() {
+    if (!mapping_) return;
+#ifdef _WIN32
+    UnmapViewOfFile(mapping_);
+    CloseHandle(static_cast<HANDLE>(mappingHandle_));
+    CloseHandle(static_cast<HANDLE>(fileHandle_));
+#else
+    ::munmap(mapping_, mappedSize_);
+#endif
+    mapping_ = nullptr;
+}
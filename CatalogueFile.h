@@ -0,0 +1,168 @@
+#ifndef CATALOGUE_FILE_H
+#define CATALOGUE_FILE_H
+
+#include "Particle.h"
+#include "ParticleCatalogue.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+// Binary catalogue format, version 1 (little-endian, all sections 8-byte aligned):
+//
+//   CatalogueFileHeader
+//   ParticleRecord[recordCount]   top-level particles first, in catalogue order, then decay products
+//   double[layerCount]            calorimeter layer energies referenced by Electron records
+//   uint32_t[linkCount]           decay-product links, as record indices
+//   char[stringTableSize]         NUL-terminated type names and colour charges
+//
+// Records have a fixed size, so a mapped file can be queried in place.
+
+enum class ParticleKind : std::uint8_t {
+    Quark,
+    Lepton,
+    Electron,
+    Muon,
+    Tau,
+    Neutrino,
+    Boson
+};
+
+struct CatalogueFileHeader {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t recordSize;
+    std::uint64_t recordCount;
+    std::uint64_t topLevelCount;
+    std::uint64_t recordOffset;
+    std::uint64_t layerOffset;
+    std::uint64_t layerCount;
+    std::uint64_t linkOffset;
+    std::uint64_t linkCount;
+    std::uint64_t stringTableOffset;
+    std::uint64_t stringTableSize;
+};
+
+struct ParticleRecord {
+    static constexpr std::uint32_t noString = 0xFFFFFFFFu;
+
+    enum Flags : std::uint8_t {
+        TopLevel = 1 << 0,
+        Isolated = 1 << 1,
+        Interacted = 1 << 2
+    };
+
+    double E, px, py, pz;
+    double charge;
+    double spin;
+    std::int32_t leptonNumber;
+    std::int32_t baryonNumber;
+    std::uint32_t typeName;     // String table offset
+    std::uint32_t colourCharge; // String table offset, noString for non-quarks
+    std::uint32_t layerBegin;
+    std::uint32_t layerCount;
+    std::uint32_t linkBegin;
+    std::uint32_t linkCount;
+    ParticleKind kind;
+    std::uint8_t flags;
+    std::uint16_t reserved0;
+    std::uint32_t reserved1;
+};
+
+static_assert(std::is_trivially_copyable<ParticleRecord>::value && std::is_standard_layout<ParticleRecord>::value,
+              "ParticleRecord is written to disk as raw bytes");
+static_assert(sizeof(ParticleRecord) == 88, "ParticleRecord layout is part of the file format");
+static_assert(sizeof(CatalogueFileHeader) == 88, "CatalogueFileHeader layout is part of the file format");
+
+class CatalogueFile {
+public:
+    static constexpr char magic[8] = {'P', 'C', 'A', 'T', 'A', 'L', 'O', 'G'};
+    static constexpr std::uint32_t version = 1;
+
+    // Serializes particles[begin, end) and all of their decay products into one image
+    static std::vector<std::byte> encode(const std::vector<std::shared_ptr<Particle>>& particles, std::size_t begin, std::size_t end);
+    // Same image for catalogue rows [begin, end), filled from the catalogue's columns
+    static std::vector<std::byte> encode(const ParticleCatalogue& catalogue, std::size_t begin, std::size_t end);
+
+    static void write(const ParticleCatalogue& catalogue, const std::string& path);
+};
+
+// Read-only view over an encoded catalogue image. The header and section bounds are checked
+// on construction; record contents are only touched when accessed.
+class CatalogueImage {
+private:
+    const CatalogueFileHeader* header_ = nullptr;
+    const ParticleRecord* records_ = nullptr;
+    const double* layers_ = nullptr;
+    const std::uint32_t* links_ = nullptr;
+    const char* strings_ = nullptr;
+
+    std::string_view stringAt(std::uint32_t offset) const;
+    std::shared_ptr<Particle> materialize(std::size_t index, std::unordered_map<std::size_t, std::shared_ptr<Particle>>& cache, int depth) const;
+
+protected:
+    CatalogueImage() = default;
+    void attach(const std::byte* data, std::size_t size);
+
+public:
+    template<typename T>
+    struct Span {
+        const T* data;
+        std::size_t size;
+        const T* begin() const { return data; }
+        const T* end() const { return data + size; }
+    };
+
+    CatalogueImage(const std::byte* data, std::size_t size) { attach(data, size); }
+
+    std::size_t size() const { return static_cast<std::size_t>(header_->recordCount); }
+    std::size_t topLevelCount() const { return static_cast<std::size_t>(header_->topLevelCount); }
+    const ParticleRecord* records() const { return records_; }
+    const ParticleRecord& record(std::size_t index) const;
+
+    std::string_view typeName(const ParticleRecord& record) const;
+    std::string_view colourCharge(const ParticleRecord& record) const;
+    Span<double> calorimeterLayers(const ParticleRecord& record) const;
+    Span<std::uint32_t> decayProducts(const ParticleRecord& record) const;
+
+    FourMomentum fourMomentum(const ParticleRecord& record) const {
+        return FourMomentum(record.E, record.px, record.py, record.pz);
+    }
+
+    // Builds the particle object for one record, including its decay tree
+    std::shared_ptr<Particle> materialize(std::size_t index) const;
+
+    // Every top-level particle in record order, under the calling thread's validation policy;
+    // shared decay products stay shared
+    std::vector<std::shared_ptr<Particle>> materializeTopLevel() const;
+
+    // Materializes every top-level record into the catalogue; shared decay products stay shared
+    void loadInto(ParticleCatalogue& catalogue) const;
+};
+
+// Memory-maps a catalogue file. Opening only validates the header, so the cost does not
+// depend on the file size; pages are faulted in as records are read.
+class MappedCatalogue : public CatalogueImage {
+private:
+    void* mapping_ = nullptr;
+    std::size_t mappedSize_ = 0;
+#ifdef _WIN32
+    void* fileHandle_ = nullptr;
+    void* mappingHandle_ = nullptr;
+#endif
+
+    void unmap();
+
+public:
+    explicit MappedCatalogue(const std::string& path);
+    ~MappedCatalogue();
+
+    MappedCatalogue(const MappedCatalogue&) = delete;
+    MappedCatalogue& operator=(const MappedCatalogue&) = delete;
+};
+
+#endif // CATALOGUE_FILE_H
@@ -0,0 +1,349 @@
+#include "CatalogueSketches.h"
+#include "Quark.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+namespace {
+
+constexpr double pi = 3.14159265358979323846;
+
+double clampUnit(double q) {
+    return std::min(1.0, std::max(0.0, q));
+}
+
+} // namespace
+
+FixedHistogram::FixedHistogram(double low, double high, std::size_t bins) {
+    if (bins == 0 || !(low < high) || !std::isfinite(high - low)) {
+        throw std::invalid_argument("FixedHistogram needs at least one bin and a finite range with low < high.");
+    }
+    low_ = low;
+    high_ = high;
+    scale_ = static_cast<double>(bins) / (high - low);
+    counts_.assign(bins, 0);
+}
+
+void FixedHistogram::bump(double x, std::int64_t delta) {
+    std::uint64_t step = static_cast<std::uint64_t>(delta);  // Wraps for removals
+    if (x != x) return;
+    if (x < low_) {
+        underflow_ += step;
+    } else if (x >= high_) {
+        overflow_ += step;
+    } else {
+        // Rounding can put values just below high_ one past the end
+        std::size_t bin = std::min(counts_.size() - 1, static_cast<std::size_t>((x - low_) * scale_));
+        counts_[bin] += step;
+    }
+}
+
+void FixedHistogram::merge(const FixedHistogram& other) {
+    if (other.low_ != low_ || other.high_ != high_ || other.counts_.size() != counts_.size()) {
+        throw std::invalid_argument("Cannot merge histograms with different binning.");
+    }
+    for (std::size_t b = 0; b < counts_.size(); b++) counts_[b] += other.counts_[b];
+    underflow_ += other.underflow_;
+    overflow_ += other.overflow_;
+}
+
+void FixedHistogram::clear() {
+    std::fill(counts_.begin(), counts_.end(), 0);
+    underflow_ = 0;
+    overflow_ = 0;
+}
+
+std::uint64_t FixedHistogram::total() const {
+    std::uint64_t total = underflow_ + overflow_;
+    for (std::uint64_t c : counts_) total += c;
+    return total;
+}
+
+double FixedHistogram::quantile(double q) const {
+    std::uint64_t n = total();
+    if (n == 0 || q != q) return std::numeric_limits<double>::quiet_NaN();
+    double target = clampUnit(q) * static_cast<double>(n);
+    double seen = static_cast<double>(underflow_);
+    if (target < seen) return low_;
+    for (std::size_t b = 0; b < counts_.size(); b++) {
+        double c = static_cast<double>(counts_[b]);
+        if (c > 0.0 && target < seen + c) return binLow(b) + (target - seen) / c * (binHigh(b) - binLow(b));
+        seen += c;
+    }
+    return high_;
+}
+
+TDigest::TDigest(double compression)
+    : compression_(compression),
+      min_(std::numeric_limits<double>::infinity()),
+      max_(-std::numeric_limits<double>::infinity()) {
+    if (!(compression >= 10.0 && compression <= 1.0e5)) {
+        throw std::invalid_argument("TDigest compression must be between 10 and 100000.");
+    }
+    values_.reserve(bufferCapacity());
+}
+
+// LSD radix sort on the IEEE bit patterns, mapped so unsigned order matches numeric order;
+// about twice as fast as std::sort for a full buffer. Passes whose byte is the same in
+// every key, typically the exponent's high byte, are skipped.
+void TDigest::sortValues() {
+    const std::size_t n = values_.size();
+    keys_.resize(n);
+    keyScratch_.resize(n);
+    std::size_t counts[8][256] = {};
+    for (std::size_t i = 0; i < n; i++) {
+        std::uint64_t bits;
+        std::memcpy(&bits, &values_[i], sizeof(bits));
+        bits = (bits >> 63) ? ~bits : bits | (std::uint64_t{1} << 63);
+        keys_[i] = bits;
+        for (int pass = 0; pass < 8; pass++) counts[pass][(bits >> (8 * pass)) & 0xFF]++;
+    }
+    for (int pass = 0; pass < 8; pass++) {
+        std::size_t* count = counts[pass];
+        int shift = 8 * pass;
+        if (count[(keys_[0] >> shift) & 0xFF] == n) continue;
+        std::size_t offset = 0;
+        for (int b = 0; b < 256; b++) {
+            std::size_t c = count[b];
+            count[b] = offset;
+            offset += c;
+        }
+        for (std::size_t i = 0; i < n; i++) keyScratch_[count[(keys_[i] >> shift) & 0xFF]++] = keys_[i];
+        keys_.swap(keyScratch_);
+    }
+    for (std::size_t i = 0; i < n; i++) {
+        std::uint64_t bits = keys_[i];
+        bits = (bits >> 63) ? bits & ~(std::uint64_t{1} << 63) : ~bits;
+        std::memcpy(&values_[i], &bits, sizeof(bits));
+    }
+    // Keeps the capacity; copies of the digest need not carry the scratch keys
+    keys_.clear();
+    keyScratch_.clear();
+}
+
+void TDigest::compress() {
+    if (values_.empty() && merged_.empty()) return;
+    if (!values_.empty()) sortValues();
+    auto byMean = [](const Centroid& a, const Centroid& b) { return a.mean < b.mean; };
+    std::sort(merged_.begin(), merged_.end(), byMean);
+
+    // Scale function k1: k(q) = delta / (2 pi) * asin(2q - 1). A centroid may span at most
+    // one unit of k, so centroids are small near q = 0 and q = 1.
+    double normalizer = compression_ / (2.0 * pi);
+    auto k = [&](double q) { return normalizer * std::asin(2.0 * clampUnit(q) - 1.0); };
+    auto qLimitAfter = [&](double q) {
+        double angle = std::min(pi / 2.0, (k(q) + 1.0) / normalizer);
+        return (std::sin(angle) + 1.0) / 2.0;
+    };
+
+    // Greedy pass over the three sorted inputs in mean order
+    std::size_t v = 0, m = 0, c = 0;
+    auto next = [&]() -> Centroid {
+        double value = v < values_.size() ? values_[v] : std::numeric_limits<double>::infinity();
+        bool fromMerged = m < merged_.size() && (c >= centroids_.size() || merged_[m].mean <= centroids_[c].mean);
+        const Centroid* other = fromMerged ? &merged_[m] : c < centroids_.size() ? &centroids_[c] : nullptr;
+        if (!other || value < other->mean) return {values_[v++], 1.0};
+        fromMerged ? m++ : c++;
+        return *other;
+    };
+    const std::size_t inputs = values_.size() + merged_.size() + centroids_.size();
+    output_.clear();
+    Centroid current = next();
+    double before = 0.0;  // Weight of the centroids already emitted
+    double qLimit = qLimitAfter(0.0);
+    for (std::size_t i = 1; i < inputs; i++) {
+        Centroid item = next();
+        if ((before + current.weight + item.weight) / totalWeight_ <= qLimit) {
+            current.weight += item.weight;
+            current.mean += (item.mean - current.mean) * item.weight / current.weight;
+        } else {
+            before += current.weight;
+            output_.push_back(current);
+            qLimit = qLimitAfter(before / totalWeight_);
+            current = item;
+        }
+    }
+    output_.push_back(current);
+    centroids_.swap(output_);
+    values_.clear();
+    merged_.clear();
+}
+
+void TDigest::merge(const TDigest& other) {
+    if (other.compression_ != compression_) {
+        throw std::invalid_argument("Cannot merge t-digests with different compression.");
+    }
+    auto push = [&](double mean, double weight) {
+        merged_.push_back({mean, weight});
+        totalWeight_ += weight;
+        if (merged_.size() >= bufferCapacity()) compress();
+    };
+    for (const Centroid& c : other.centroids_) push(c.mean, c.weight);
+    for (const Centroid& c : other.merged_) push(c.mean, c.weight);
+    for (double x : other.values_) push(x, 1.0);
+    min_ = std::min(min_, other.min_);
+    max_ = std::max(max_, other.max_);
+}
+
+void TDigest::clear() {
+    centroids_.clear();
+    values_.clear();
+    merged_.clear();
+    totalWeight_ = 0.0;
+    min_ = std::numeric_limits<double>::infinity();
+    max_ = -std::numeric_limits<double>::infinity();
+}
+
+double TDigest::quantile(double q) const {
+    if (!values_.empty() || !merged_.empty()) {
+        TDigest compressed(*this);
+        compressed.compress();
+        return compressed.quantile(q);
+    }
+    if (centroids_.empty() || q != q) return std::numeric_limits<double>::quiet_NaN();
+    if (q <= 0.0) return min_;
+    if (q >= 1.0) return max_;
+    if (centroids_.size() == 1) return centroids_[0].mean;
+
+    // Each centroid's weight is taken to be centred on its mean; interpolate between
+    // neighbouring centres, and between the outer centres and min or max
+    double target = q * totalWeight_;
+    const Centroid& first = centroids_.front();
+    if (target < first.weight / 2.0) return min_ + (first.mean - min_) * target / (first.weight / 2.0);
+    double seen = first.weight / 2.0;
+    for (std::size_t i = 0; i + 1 < centroids_.size(); i++) {
+        double step = (centroids_[i].weight + centroids_[i + 1].weight) / 2.0;
+        if (target < seen + step) return centroids_[i].mean + (centroids_[i + 1].mean - centroids_[i].mean) * (target - seen) / step;
+        seen += step;
+    }
+    const Centroid& last = centroids_.back();
+    return last.mean + (max_ - last.mean) * std::min(1.0, (target - seen) / (last.weight / 2.0));
+}
+
+double TDigest::cdf(double x) const {
+    if (!values_.empty() || !merged_.empty()) {
+        TDigest compressed(*this);
+        compressed.compress();
+        return compressed.cdf(x);
+    }
+    if (centroids_.empty() || x != x) return std::numeric_limits<double>::quiet_NaN();
+    if (x < min_) return 0.0;
+    if (x >= max_) return 1.0;
+    if (centroids_.size() == 1) return 0.5;
+
+    const Centroid& first = centroids_.front();
+    if (x < first.mean) return first.weight / 2.0 * (x - min_) / (first.mean - min_) / totalWeight_;
+    double seen = first.weight / 2.0;
+    for (std::size_t i = 0; i + 1 < centroids_.size(); i++) {
+        double step = (centroids_[i].weight + centroids_[i + 1].weight) / 2.0;
+        if (x < centroids_[i + 1].mean) {
+            return (seen + step * (x - centroids_[i].mean) / (centroids_[i + 1].mean - centroids_[i].mean)) / totalWeight_;
+        }
+        seen += step;
+    }
+    const Centroid& last = centroids_.back();
+    return (seen + last.weight / 2.0 * (x - last.mean) / (max_ - last.mean)) / totalWeight_;
+}
+
+HyperLogLog::HyperLogLog(unsigned precision) : precision_(precision) {
+    if (precision < 4 || precision > 18) {
+        throw std::invalid_argument("HyperLogLog precision must be between 4 and 18.");
+    }
+    registers_.assign(std::size_t{1} << precision, 0);
+}
+
+void HyperLogLog::merge(const HyperLogLog& other) {
+    if (other.precision_ != precision_) {
+        throw std::invalid_argument("Cannot merge HyperLogLog counters with different precision.");
+    }
+    for (std::size_t i = 0; i < registers_.size(); i++) registers_[i] = std::max(registers_[i], other.registers_[i]);
+}
+
+void HyperLogLog::clear() {
+    std::fill(registers_.begin(), registers_.end(), 0);
+}
+
+double HyperLogLog::estimate() const {
+    double m = static_cast<double>(registers_.size());
+    double alpha = registers_.size() == 16 ? 0.673 : registers_.size() == 32 ? 0.697 : registers_.size() == 64 ? 0.709 : 0.7213 / (1.0 + 1.079 / m);
+    double sum = 0.0;
+    std::size_t zeros = 0;
+    for (std::uint8_t r : registers_) {
+        sum += std::ldexp(1.0, -static_cast<int>(r));
+        if (r == 0) zeros++;
+    }
+    double raw = alpha * m * m / sum;
+    // Linear counting is more accurate while many registers are still empty
+    if (raw <= 2.5 * m && zeros != 0) return m * std::log(m / static_cast<double>(zeros));
+    return raw;
+}
+
+std::uint64_t HyperLogLog::hash(std::string_view key, std::uint64_t seed) {
+    // FNV-1a, then the MurmurHash3 finalizer for avalanche
+    std::uint64_t h = 0xCBF29CE484222325ull ^ (seed * 0x9E3779B97F4A7C15ull);
+    for (char c : key) {
+        h ^= static_cast<unsigned char>(c);
+        h *= 0x100000001B3ull;
+    }
+    h ^= h >> 33;
+    h *= 0xFF51AFD7ED558CCDull;
+    h ^= h >> 33;
+    h *= 0xC4CEB9FE1A85EC53ull;
+    h ^= h >> 33;
+    return h;
+}
+
+CatalogueSketches::CatalogueSketches(const Config& config)
+    : config_(config),
+      energyHistogram_(config.energyMin, config.energyMax, config.energyBins),
+      ptHistogram_(config.ptMin, config.ptMax, config.ptBins),
+      energyDigest_(config.compression),
+      ptDigest_(config.compression),
+      species_(config.distinctPrecision) {}
+
+void CatalogueSketches::add(const ParticleColumns& columns, std::size_t row, const Particle& particle) {
+    double E = columns.energy()[row];
+    double pT = std::hypot(columns.px()[row], columns.py()[row]);
+    energyHistogram_.add(E);
+    ptHistogram_.add(pT);
+    energyDigest_.add(E);
+    ptDigest_.add(pT);
+    std::uint64_t key = HyperLogLog::hash(particle.getType());
+    // Only Quark reports quark ids, so the id check stands in for a dynamic_cast per row
+    if (isQuark(particle.getId())) key = HyperLogLog::hash(static_cast<const Quark&>(particle).getColorCharge(), key);
+    species_.addHash(key);
+    size_++;
+}
+
+void CatalogueSketches::replaceMomentum(const FourMomentum& before, const FourMomentum& after) {
+    energyHistogram_.remove(before.data()[0]);
+    ptHistogram_.remove(std::hypot(before.data()[1], before.data()[2]));
+    energyHistogram_.add(after.data()[0]);
+    ptHistogram_.add(std::hypot(after.data()[1], after.data()[2]));
+}
+
+void CatalogueSketches::merge(const CatalogueSketches& other) {
+    const Config& a = config_;
+    const Config& b = other.config_;
+    if (a.energyMin != b.energyMin || a.energyMax != b.energyMax || a.energyBins != b.energyBins || a.ptMin != b.ptMin ||
+        a.ptMax != b.ptMax || a.ptBins != b.ptBins || a.compression != b.compression || a.distinctPrecision != b.distinctPrecision) {
+        throw std::invalid_argument("Cannot merge catalogue sketches with different configurations.");
+    }
+    energyHistogram_.merge(other.energyHistogram_);
+    ptHistogram_.merge(other.ptHistogram_);
+    energyDigest_.merge(other.energyDigest_);
+    ptDigest_.merge(other.ptDigest_);
+    species_.merge(other.species_);
+    size_ += other.size_;
+}
+
+void CatalogueSketches::clear() {
+    energyHistogram_.clear();
+    ptHistogram_.clear();
+    energyDigest_.clear();
+    ptDigest_.clear();
+    species_.clear();
+    size_ = 0;
+}
@@ -0,0 +1,193 @@
+#ifndef CATALOGUE_SKETCHES_H
+#define CATALOGUE_SKETCHES_H
+
+#include "FourMomentum.h"
+#include "Particle.h"
+#include "ParticleColumns.h"
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+// Streaming summaries whose memory does not grow with the number of values. Each can be
+// merged with another of the same configuration, so per-thread or per-shard sketches
+// combine into one.
+
+// Counts in equal-width bins over [low, high), with separate underflow and overflow
+// counts. NaN values are ignored.
+class FixedHistogram {
+private:
+    double low_ = 0.0, high_ = 1.0, scale_ = 1.0;
+    std::vector<std::uint64_t> counts_;
+    std::uint64_t underflow_ = 0, overflow_ = 0;
+
+    void bump(double x, std::int64_t delta);
+
+public:
+    FixedHistogram() : FixedHistogram(0.0, 1.0, 1) {}
+    FixedHistogram(double low, double high, std::size_t bins);
+
+    void add(double x) { bump(x, 1); }
+    // Takes back one earlier add(x), e.g. when a value is corrected in place
+    void remove(double x) { bump(x, -1); }
+    // Requires the same binning; throws std::invalid_argument otherwise
+    void merge(const FixedHistogram& other);
+    void clear();
+
+    double low() const { return low_; }
+    double high() const { return high_; }
+    std::size_t bins() const { return counts_.size(); }
+    double binLow(std::size_t bin) const { return low_ + static_cast<double>(bin) * (high_ - low_) / static_cast<double>(counts_.size()); }
+    double binHigh(std::size_t bin) const { return binLow(bin + 1); }
+    std::uint64_t count(std::size_t bin) const { return counts_[bin]; }
+    const std::vector<std::uint64_t>& counts() const { return counts_; }
+    std::uint64_t underflow() const { return underflow_; }
+    std::uint64_t overflow() const { return overflow_; }
+    std::uint64_t total() const;
+
+    // Quantile q in [0, 1], interpolated linearly within its bin; clamps to low() or high()
+    // when it falls in the underflow or overflow, NaN when empty
+    double quantile(double q) const;
+};
+
+// Merging t-digest (Dunning): values are buffered and periodically merged into at most
+// about compression / 2 centroids, sized so quantiles near 0 and 1 stay most accurate.
+// Typical rank error is well under 1% at the default compression. NaN values are ignored.
+class TDigest {
+public:
+    struct Centroid {
+        double mean;
+        double weight;
+    };
+
+private:
+    double compression_;
+    std::vector<Centroid> centroids_;  // Sorted by mean
+    std::vector<double> values_;       // Added since the last compress(), bounded by bufferCapacity()
+    std::vector<Centroid> merged_;     // Centroids of merged digests, likewise
+    double totalWeight_ = 0.0;         // Including the buffers
+    double min_, max_;
+    std::vector<std::uint64_t> keys_, keyScratch_;  // Radix sort of values_
+    std::vector<Centroid> output_;                   // Next centroids_, built by compress()
+
+    std::size_t bufferCapacity() const { return static_cast<std::size_t>(compression_) * 8; }
+    void sortValues();
+
+public:
+    explicit TDigest(double compression = 200.0);
+
+    void add(double x) {
+        if (x != x) return;
+        values_.push_back(x);
+        totalWeight_ += 1.0;
+        if (x < min_) min_ = x;
+        if (x > max_) max_ = x;
+        if (values_.size() >= bufferCapacity()) compress();
+    }
+
+    // Requires the same compression; throws std::invalid_argument otherwise
+    void merge(const TDigest& other);
+    // Merges the buffered values into the centroids
+    void compress();
+    void clear();
+
+    double compression() const { return compression_; }
+    double count() const { return totalWeight_; }
+    double min() const { return min_; }
+    double max() const { return max_; }
+    // Centroids after compress(); buffered values are not included
+    const std::vector<Centroid>& centroids() const { return centroids_; }
+
+    // Quantile q in [0, 1], NaN when empty. Works on a compressed copy if values are buffered.
+    double quantile(double q) const;
+    // Fraction of the weight below x, NaN when empty
+    double cdf(double x) const;
+};
+
+// HyperLogLog distinct counter over 64-bit hashes with 2^precision one-byte registers.
+// The relative standard error is about 1.04 / sqrt(2^precision), 1.6% at the default;
+// small counts use linear counting and are close to exact.
+class HyperLogLog {
+private:
+    unsigned precision_;
+    std::vector<std::uint8_t> registers_;
+
+public:
+    explicit HyperLogLog(unsigned precision = 12);
+
+    void addHash(std::uint64_t hash) {
+        std::size_t bucket = static_cast<std::size_t>(hash >> (64 - precision_));
+        // A sentinel bit keeps the rank within 64 - precision + 1
+        std::uint64_t rest = (hash << precision_) | (std::uint64_t{1} << (precision_ - 1));
+        std::uint8_t rank = 1;
+        while (!(rest & (std::uint64_t{1} << 63))) {
+            rest <<= 1;
+            rank++;
+        }
+        if (rank > registers_[bucket]) registers_[bucket] = rank;
+    }
+
+    void add(std::string_view key) { addHash(hash(key)); }
+
+    // Requires the same precision; throws std::invalid_argument otherwise
+    void merge(const HyperLogLog& other);
+    void clear();
+
+    unsigned precision() const { return precision_; }
+    double estimate() const;
+
+    // 64-bit hash used by add(), with full avalanche so any slice of the bits is usable;
+    // seed chains several fields into one key
+    static std::uint64_t hash(std::string_view key, std::uint64_t seed = 0);
+};
+
+// Distributions and distinct counts over the rows of a catalogue: energy and pT histograms
+// and quantile digests, and a distinct count of (getType(), colour charge) combinations,
+// the colour charge only for quarks. Like CatalogueAggregates they are updated in O(1)
+// per added row and do not depend on row order.
+class CatalogueSketches {
+public:
+    struct Config {
+        double energyMin = 0.0, energyMax = 1.0e6;  // MeV
+        std::size_t energyBins = 1000;
+        double ptMin = 0.0, ptMax = 2.0e5;          // MeV
+        std::size_t ptBins = 1000;
+        double compression = 200.0;                 // TDigest
+        unsigned distinctPrecision = 12;            // HyperLogLog
+    };
+
+private:
+    Config config_;
+    FixedHistogram energyHistogram_, ptHistogram_;
+    TDigest energyDigest_, ptDigest_;
+    HyperLogLog species_;
+    std::size_t size_ = 0;
+
+public:
+    CatalogueSketches() : CatalogueSketches(Config()) {}
+    explicit CatalogueSketches(const Config& config);
+
+    void add(const ParticleColumns& columns, std::size_t row, const Particle& particle);
+
+    // For a row whose momentum was corrected in place. Histograms follow the correction;
+    // digests cannot take values back, so they keep the momentum the row was added with.
+    void replaceMomentum(const FourMomentum& before, const FourMomentum& after);
+
+    // Requires the same Config; throws std::invalid_argument otherwise
+    void merge(const CatalogueSketches& other);
+    void clear();
+
+    const Config& getConfig() const { return config_; }
+    std::size_t size() const { return size_; }
+    const FixedHistogram& energyHistogram() const { return energyHistogram_; }
+    const FixedHistogram& ptHistogram() const { return ptHistogram_; }
+    const TDigest& energyDigest() const { return energyDigest_; }
+    const TDigest& ptDigest() const { return ptDigest_; }
+    const HyperLogLog& distinctSpecies() const { return species_; }
+
+    double energyQuantile(double q) const { return energyDigest_.quantile(q); }
+    double ptQuantile(double q) const { return ptDigest_.quantile(q); }
+    double distinctSpeciesEstimate() const { return species_.estimate(); }
+};
+
+#endif // CATALOGUE_SKETCHES_H
@@ -0,0 +1,285 @@
+#ifndef CONCURRENT_PARTICLE_CATALOGUE_H
+#define CONCURRENT_PARTICLE_CATALOGUE_H
+
+#include "CatalogueAggregates.h"
+#include "Particle.h"
+#include "ParticleCatalogue.h"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Particle catalogue that many threads can append to at once without locking.
+//
+// Every producer thread appends to its own segment, a chunked vector that only that thread
+// writes: an append fills the next row and publishes the new size with a release store, and
+// chunks never move once allocated. Readers take a Snapshot, the published size of every
+// segment, and can scan it while the writers keep going. A snapshot contains every particle
+// whose addParticle happened before it was taken, and the particles of each thread in the
+// order that thread added them; it stays valid until clear() or destruction.
+//
+// Indexed queries are not maintained here; copy a snapshot into a ParticleCatalogue for those.
+class ConcurrentParticleCatalogue {
+private:
+    struct Row {
+        std::shared_ptr<Particle> particle;
+        std::string_view type;  // getType() names point into static storage
+        double E, px, py, pz, charge;
+    };
+
+    class Segment {
+    private:
+        static constexpr std::size_t firstChunkRows = 1024;
+        static constexpr std::size_t maxChunks = 40;  // Chunk k holds firstChunkRows << k rows
+
+        std::array<std::atomic<Row*>, maxChunks> chunks_{};
+        std::atomic<std::size_t> size_{0};
+        std::size_t chunk_ = 0;   // Writer side: chunk being filled
+        std::size_t offset_ = 0;  // Writer side: next row in that chunk
+
+        static std::size_t chunkRows(std::size_t chunk) { return firstChunkRows << chunk; }
+
+    public:
+        ~Segment() {
+            for (auto& chunk : chunks_) delete[] chunk.load(std::memory_order_relaxed);
+        }
+
+        // Owning thread only
+        void append(const std::shared_ptr<Particle>& particle) {
+            if (chunk_ == maxChunks) {
+                throw std::length_error("ConcurrentParticleCatalogue segment is full.");
+            }
+            Row* rows = chunks_[chunk_].load(std::memory_order_relaxed);
+            if (!rows) {
+                rows = new Row[chunkRows(chunk_)];
+                chunks_[chunk_].store(rows, std::memory_order_relaxed);
+            }
+            FourMomentum p = particle->getFourMomentum();
+            rows[offset_] = Row{particle, particle->getType(), p.getComponent(0), p.getComponent(1), p.getComponent(2), p.getComponent(3), particle->charge()};
+            if (++offset_ == chunkRows(chunk_)) {
+                chunk_++;
+                offset_ = 0;
+            }
+            size_.store(size_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+        }
+
+        std::size_t publishedSize() const { return size_.load(std::memory_order_acquire); }
+
+        // Calls fn(row) for the first n rows; n must not exceed a size read with publishedSize()
+        template<typename Fn>
+        void forEach(std::size_t n, Fn&& fn) const {
+            for (std::size_t chunk = 0; n > 0; chunk++) {
+                const Row* rows = chunks_[chunk].load(std::memory_order_relaxed);
+                std::size_t count = std::min(n, chunkRows(chunk));
+                for (std::size_t i = 0; i < count; i++) fn(rows[i]);
+                n -= count;
+            }
+        }
+
+        // No appends or readers may run concurrently; chunks are kept for reuse
+        void clear() {
+            std::size_t n = size_.load(std::memory_order_relaxed);
+            for (std::size_t chunk = 0; n > 0; chunk++) {
+                Row* rows = chunks_[chunk].load(std::memory_order_relaxed);
+                std::size_t count = std::min(n, chunkRows(chunk));
+                for (std::size_t i = 0; i < count; i++) rows[i].particle.reset();
+                n -= count;
+            }
+            size_.store(0, std::memory_order_relaxed);
+            chunk_ = 0;
+            offset_ = 0;
+        }
+    };
+
+    static std::uint64_t nextId() {
+        static std::atomic<std::uint64_t> counter{0};
+        return counter.fetch_add(1, std::memory_order_relaxed) + 1;
+    }
+
+    const std::uint64_t id_ = nextId();  // Keys the per-thread writer cache; never reused
+    const std::shared_ptr<const void> alive_ = std::make_shared<char>();  // Expires cache entries on destruction
+    mutable std::mutex segmentsMutex_;  // Guards the segment list only, not the appends
+    std::vector<std::unique_ptr<Segment>> segments_;
+
+    Segment* newSegment() {
+        std::lock_guard<std::mutex> lock(segmentsMutex_);
+        segments_.push_back(std::make_unique<Segment>());
+        return segments_.back().get();
+    }
+
+public:
+    // Append handle for one producer thread. It must not be shared between threads or
+    // outlive the catalogue.
+    class Writer {
+    private:
+        Segment* segment_;
+
+    public:
+        explicit Writer(Segment* segment) : segment_(segment) {}
+
+        void addParticle(const std::shared_ptr<Particle>& particle) {
+            if (particle) {
+                segment_->append(particle);
+            } else {
+                std::cerr << "Attempted to add a null particle to the catalogue." << std::endl;
+            }
+        }
+    };
+
+    // Consistent view of the catalogue at one moment
+    class Snapshot {
+    private:
+        std::vector<std::pair<const Segment*, std::size_t>> segments_;
+        std::size_t size_ = 0;
+
+        template<typename Fn>
+        void forEachRow(Fn&& fn) const {
+            for (const auto& segment : segments_) segment.first->forEach(segment.second, fn);
+        }
+
+        friend class ConcurrentParticleCatalogue;
+
+    public:
+        size_t getTotalNumberOfParticles() const { return size_; }
+
+        FourMomentum getTotalFourMomentum() const {
+            CompensatedSum E, px, py, pz;
+            forEachRow([&](const Row& row) {
+                E.add(row.E);
+                px.add(row.px);
+                py.add(row.py);
+                pz.add(row.pz);
+            });
+            return FourMomentum::unchecked(E.value(), px.value(), py.value(), pz.value());  // May round slightly spacelike
+        }
+
+        double getTotalCharge() const {
+            CompensatedSum charge;
+            forEachRow([&](const Row& row) { charge.add(row.charge); });
+            return charge.value();
+        }
+
+        std::unordered_map<std::string, int> getParticleCounts() const {
+            std::unordered_map<std::string_view, int> byName;
+            forEachRow([&](const Row& row) { byName[row.type]++; });
+            std::unordered_map<std::string, int> counts;
+            for (const auto& entry : byName) counts[std::string(entry.first)] = entry.second;
+            return counts;
+        }
+
+        std::vector<std::shared_ptr<Particle>> getParticles() const {
+            std::vector<std::shared_ptr<Particle>> result;
+            result.reserve(size_);
+            forEachRow([&](const Row& row) { result.push_back(row.particle); });
+            return result;
+        }
+
+        std::vector<std::shared_ptr<Particle>> filterParticles(const std::function<bool(const std::shared_ptr<Particle>&)>& pred) const {
+            std::vector<std::shared_ptr<Particle>> result;
+            forEachRow([&](const Row& row) {
+                if (pred(row.particle)) result.push_back(row.particle);
+            });
+            return result;
+        }
+
+        // Adds the snapshot's particles to a ParticleCatalogue for indexed queries
+        void copyTo(ParticleCatalogue& catalogue) const {
+            catalogue.reserve(catalogue.getTotalNumberOfParticles() + size_);
+            forEachRow([&](const Row& row) { catalogue.addParticle(row.particle); });
+        }
+    };
+
+    ConcurrentParticleCatalogue() = default;
+    ConcurrentParticleCatalogue(const ConcurrentParticleCatalogue&) = delete;
+    ConcurrentParticleCatalogue& operator=(const ConcurrentParticleCatalogue&) = delete;
+
+    // A new segment for the calling thread; the fastest way to append from a thread pool
+    Writer writer() {
+        return Writer(newSegment());
+    }
+
+    // Appends through a segment owned by the calling thread, found in a thread-local cache.
+    // The first call from each thread takes a lock to register its segment; entries of
+    // destroyed catalogues are dropped then, so the cache only holds live catalogues.
+    void addParticle(const std::shared_ptr<Particle>& particle) {
+        struct CachedSegment {
+            std::uint64_t catalogue;
+            std::weak_ptr<const void> alive;
+            Segment* segment;
+        };
+        thread_local std::vector<CachedSegment> segments;
+        Segment* segment = nullptr;
+        for (const CachedSegment& entry : segments) {
+            if (entry.catalogue == id_) {
+                segment = entry.segment;
+                break;
+            }
+        }
+        if (!segment) {
+            segments.erase(std::remove_if(segments.begin(), segments.end(),
+                                          [](const CachedSegment& entry) { return entry.alive.expired(); }),
+                           segments.end());
+            segment = newSegment();
+            segments.push_back({id_, alive_, segment});
+        }
+        Writer(segment).addParticle(particle);
+    }
+
+    Snapshot snapshot() const {
+        Snapshot snapshot;
+        std::lock_guard<std::mutex> lock(segmentsMutex_);
+        snapshot.segments_.reserve(segments_.size());
+        for (const auto& segment : segments_) {
+            std::size_t size = segment->publishedSize();
+            if (size == 0) continue;
+            snapshot.segments_.emplace_back(segment.get(), size);
+            snapshot.size_ += size;
+        }
+        return snapshot;
+    }
+
+    size_t getTotalNumberOfParticles() const {
+        std::lock_guard<std::mutex> lock(segmentsMutex_);
+        size_t total = 0;
+        for (const auto& segment : segments_) total += segment->publishedSize();
+        return total;
+    }
+
+    // Segments registered so far, cleared ones included
+    size_t segmentCount() const {
+        std::lock_guard<std::mutex> lock(segmentsMutex_);
+        return segments_.size();
+    }
+
+    FourMomentum getTotalFourMomentum() const {
+        return snapshot().getTotalFourMomentum();
+    }
+
+    std::unordered_map<std::string, int> getParticleCounts() const {
+        return snapshot().getParticleCounts();
+    }
+
+    std::vector<std::shared_ptr<Particle>> filterParticles(const std::function<bool(const std::shared_ptr<Particle>&)>& pred) const {
+        return snapshot().filterParticles(pred);
+    }
+
+    // Must not run concurrently with appends or with readers of earlier snapshots. Writers
+    // and thread-local segments stay usable afterwards.
+    void clear() {
+        std::lock_guard<std::mutex> lock(segmentsMutex_);
+        for (auto& segment : segments_) segment->clear();
+    }
+};
+
+#endif // CONCURRENT_PARTICLE_CATALOGUE_H
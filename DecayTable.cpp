@@ -0,0 +1,151 @@
+#include "DecayTable.h"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <unordered_map>
+#include <utility>
+
+namespace {
+
+struct Pending {
+    const Particle* particle;
+    DecayTable::Node parent;
+    std::size_t row;
+    std::size_t depth;  // Products since the last catalogued ancestor
+};
+
+void checkDepth(std::size_t depth) {
+    if (depth > DecayTable::maxProductDepth) {
+        throw std::runtime_error("Decay chain too deep in catalogue (cyclic decay products?).");
+    }
+}
+
+} // namespace
+
+DecayTable::Node DecayTable::addNode(const Particle& particle, Node parent, std::size_t row) {
+    Node node = static_cast<Node>(parent_.size());
+    FourMomentum p = particle.getFourMomentum();
+    particle_.push_back(&particle);
+    parent_.push_back(parent);
+    end_.push_back(node + 1);
+    depth_.push_back(parent == npos ? 0 : depth_[parent] + 1);
+    id_.push_back(particle.getId());
+    momentum_.push_back({p.data()[0], p.data()[1], p.data()[2], p.data()[3]});
+    row_.push_back(row);
+    return node;
+}
+
+DecayTable::DecayTable(const std::vector<std::shared_ptr<Particle>>& particles) {
+    const std::size_t n = particles.size();
+    std::unordered_map<const Particle*, std::size_t> rowOf;
+    rowOf.reserve(n);
+    for (std::size_t row = 0; row < n; row++) {
+        if (particles[row]) rowOf.emplace(particles[row].get(), row);
+    }
+    auto catalogueRow = [&](const Particle* particle) {
+        auto it = rowOf.find(particle);
+        return it != rowOf.end() ? it->second : noRow;
+    };
+
+    // Rows found inside another row's decay tree are not roots. Each walk stops at
+    // catalogued products, which are walked from their own row.
+    std::vector<char> reached(n, 0);
+    std::vector<std::pair<const Particle*, std::size_t>> walk;
+    for (std::size_t row = 0; row < n; row++) {
+        if (!particles[row]) continue;
+        for (const auto& product : particles[row]->getDecayProducts()) walk.emplace_back(product.get(), 1);
+        while (!walk.empty()) {
+            auto [particle, depth] = walk.back();
+            walk.pop_back();
+            if (!particle) continue;
+            std::size_t productRow = catalogueRow(particle);
+            if (productRow != noRow) {
+                if (productRow != row) reached[productRow] = 1;
+                continue;
+            }
+            checkDepth(depth);
+            for (const auto& product : particle->getDecayProducts()) walk.emplace_back(product.get(), depth + 1);
+        }
+    }
+
+    rowNode_.assign(n, npos);
+    std::vector<Pending> stack;
+    auto place = [&](std::size_t root) {
+        stack.push_back({particles[root].get(), npos, root, 0});
+        while (!stack.empty()) {
+            Pending next = stack.back();
+            stack.pop_back();
+            if (next.row != noRow && rowNode_[next.row] != npos) continue;
+            std::size_t depth = next.row != noRow ? 0 : next.depth;
+            checkDepth(depth);
+            Node node = addNode(*next.particle, next.parent, next.row);
+            if (next.row != noRow) rowNode_[next.row] = node;
+            if (next.parent == npos) roots_.push_back(node);
+            // Reversed, so the first product is placed first
+            const auto& products = next.particle->getDecayProducts();
+            for (auto it = products.rbegin(); it != products.rend(); ++it) {
+                if (*it) stack.push_back({it->get(), node, catalogueRow(it->get()), depth + 1});
+            }
+        }
+    };
+    for (std::size_t row = 0; row < n; row++) {
+        if (particles[row] && !reached[row]) place(row);
+    }
+    // Rows reachable only through a cycle of catalogued particles
+    for (std::size_t row = 0; row < n; row++) {
+        if (particles[row] && rowNode_[row] == npos) place(row);
+    }
+
+    // In preorder a parent precedes its subtree, so one backward pass closes every range
+    for (std::size_t node = parent_.size(); node-- > 0;) {
+        if (parent_[node] != npos) end_[parent_[node]] = std::max(end_[parent_[node]], end_[node]);
+    }
+}
+
+std::vector<DecayTable::Node> DecayTable::finalStateDescendants(Node node) const {
+    std::vector<Node> result;
+    forEachDescendant(node, [&](Node d) {
+        if (isFinalState(d)) result.push_back(d);
+    });
+    return result;
+}
+
+std::size_t DecayTable::countDescendants(Node node, ParticleId id) const {
+    return static_cast<std::size_t>(std::count(id_.begin() + node + 1, id_.begin() + end_[node], id));
+}
+
+std::array<double, 4> DecayTable::daughterSum(Node node) const {
+    std::array<double, 4> sum{0.0, 0.0, 0.0, 0.0};
+    forEachChild(node, [&](Node child) {
+        for (int k = 0; k < 4; k++) sum[k] += momentum_[child][k];
+    });
+    return sum;
+}
+
+std::vector<DecayTable::Node> DecayTable::conservationViolations(double tolerance) const {
+    std::vector<std::array<double, 4>> sums(size(), std::array<double, 4>{0.0, 0.0, 0.0, 0.0});
+    for (Node node = 0; node < size(); node++) {
+        if (parent_[node] == npos) continue;
+        for (int k = 0; k < 4; k++) sums[parent_[node]][k] += momentum_[node][k];
+    }
+    std::vector<Node> result;
+    for (Node node = 0; node < size(); node++) {
+        if (isFinalState(node)) continue;
+        double limit = tolerance * std::max(1.0, std::fabs(momentum_[node][0]));
+        for (int k = 0; k < 4; k++) {
+            if (std::fabs(momentum_[node][k] - sums[node][k]) > limit) {
+                result.push_back(node);
+                break;
+            }
+        }
+    }
+    return result;
+}
+
+std::vector<DecayTable::Node> DecayTable::findWithDescendants(ParticleId ancestor, ParticleId descendant, std::size_t minCount) const {
+    std::vector<Node> result;
+    for (Node node = 0; node < size(); node++) {
+        if (id_[node] == ancestor && countDescendants(node, descendant) >= minCount) result.push_back(node);
+    }
+    return result;
+}
@@ -0,0 +1,89 @@
+#ifndef DECAY_TABLE_H
+#define DECAY_TABLE_H
+
+#include "Particle.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// Decay trees of a catalogue flattened into one table. Nodes are numbered in depth-first
+// preorder, so the descendants of node i are exactly the nodes in (i, subtreeEnd(i)) and a
+// depth-first walk is a linear scan. Every catalogue row has a node; decay products that
+// are also catalogued sit inside their parent's subtree, and the other rows are roots.
+//
+// Nodes hold raw particle pointers and copies of the four-momenta, so traversals do no
+// virtual calls and touch no reference counts. The table is a snapshot: it must be rebuilt
+// after the catalogue or any decay product list changes.
+class DecayTable {
+public:
+    using Node = std::uint32_t;
+    static constexpr Node npos = 0xFFFFFFFFu;
+    static constexpr std::size_t noRow = static_cast<std::size_t>(-1);
+    // Longest chain of decay products between catalogued particles; only a cycle gets there
+    static constexpr std::size_t maxProductDepth = 256;
+
+    DecayTable() = default;
+
+    // Walks the decay products of particles[0..n) iteratively. A catalogued product listed
+    // by two parents is placed under the first one only. Throws std::runtime_error when
+    // uncatalogued decay products form a cycle.
+    explicit DecayTable(const std::vector<std::shared_ptr<Particle>>& particles);
+
+    std::size_t size() const { return parent_.size(); }
+    const std::vector<Node>& roots() const { return roots_; }
+
+    Node parent(Node node) const { return parent_[node]; }
+    Node subtreeEnd(Node node) const { return end_[node]; }
+    std::uint32_t depth(Node node) const { return depth_[node]; }
+    bool isFinalState(Node node) const { return end_[node] == node + 1; }
+    const Particle& particle(Node node) const { return *particle_[node]; }
+    ParticleId id(Node node) const { return id_[node]; }
+    const std::array<double, 4>& momentum(Node node) const { return momentum_[node]; }
+
+    // Catalogue row of a node, or noRow for decay products that are not catalogued
+    std::size_t row(Node node) const { return row_[node]; }
+    Node nodeOfRow(std::size_t row) const { return rowNode_[row]; }
+
+    // Calls fn(child) for the direct decay products of node
+    template<typename Fn>
+    void forEachChild(Node node, Fn&& fn) const {
+        for (Node child = node + 1; child < end_[node]; child = end_[child]) fn(child);
+    }
+
+    // Calls fn(descendant) in depth-first order, excluding node itself
+    template<typename Fn>
+    void forEachDescendant(Node node, Fn&& fn) const {
+        for (Node d = node + 1; d < end_[node]; d++) fn(d);
+    }
+
+    std::vector<Node> finalStateDescendants(Node node) const;
+    std::size_t countDescendants(Node node, ParticleId id) const;
+
+    // Sum of the four-momenta of the direct decay products, zero for final-state nodes
+    std::array<double, 4> daughterSum(Node node) const;
+
+    // Nodes with decay products whose summed four-momentum differs from their own by more
+    // than tolerance * max(1, E) in any component; one linear pass over the table
+    std::vector<Node> conservationViolations(double tolerance) const;
+
+    // Nodes of type ancestor with at least minCount descendants of type descendant,
+    // e.g. (Higgs, Muon, 4) for H -> 4 mu candidates
+    std::vector<Node> findWithDescendants(ParticleId ancestor, ParticleId descendant, std::size_t minCount) const;
+
+private:
+    std::vector<const Particle*> particle_;
+    std::vector<Node> parent_;
+    std::vector<Node> end_;
+    std::vector<std::uint32_t> depth_;
+    std::vector<ParticleId> id_;
+    std::vector<std::array<double, 4>> momentum_;
+    std::vector<std::size_t> row_;
+    std::vector<Node> rowNode_;
+    std::vector<Node> roots_;
+
+    Node addNode(const Particle& particle, Node parent, std::size_t row);
+};
+
+#endif // DECAY_TABLE_H
@@ -0,0 +1,282 @@
+#include "EventGenerator.h"
+#include "Boson.h"
+#include "Lepton.h"
+#include "LorentzTransform.h"
+#include "ParallelExecutor.h"
+#include "Quark.h"
+#include <array>
+#include <cmath>
+#include <utility>
+
+namespace {
+
+constexpr double pi = 3.14159265358979323846;
+
+std::uint64_t mix(std::uint64_t z) {
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+// SplitMix64 with hand-written distributions: the standard library distributions are
+// implementation defined, and a seed must give the same events on every platform.
+class Random {
+private:
+    std::uint64_t state_;
+
+public:
+    explicit Random(std::uint64_t seed) : state_(seed) {}
+
+    std::uint64_t next() {
+        return mix(state_ += 0x9e3779b97f4a7c15ULL);
+    }
+
+    double uniform() { return static_cast<double>(next() >> 11) * 0x1.0p-53; }
+    double uniform(double lo, double hi) { return lo + (hi - lo) * uniform(); }
+    bool chance(double probability) { return uniform() < probability; }
+    double exponential(double mean) { return -mean * std::log1p(-uniform()); }
+
+    // Knuth's method; the means used here are small
+    unsigned poisson(double mean) {
+        if (mean <= 0.0) return 0;
+        double limit = std::exp(-mean), product = uniform();
+        unsigned count = 0;
+        while (product > limit) {
+            product *= uniform();
+            count++;
+        }
+        return count;
+    }
+
+    template<std::size_t N>
+    std::size_t pick(const std::array<double, N>& weights) {
+        double total = 0.0;
+        for (double w : weights) total += w;
+        double x = uniform() * total;
+        for (std::size_t i = 0; i + 1 < N; i++) {
+            if ((x -= weights[i]) < 0.0) return i;
+        }
+        return N - 1;
+    }
+};
+
+double massOf(ParticleId id) {
+    return particleProperties(id).mass;
+}
+
+// E from the mass, summed in the order validate() uses, so E >= |p| holds exactly
+FourMomentum onShell(double mass, double px, double py, double pz) {
+    return FourMomentum(std::sqrt(mass * mass + px * px + py * py + pz * pz), px, py, pz);
+}
+
+FourMomentum onShell(double mass, const FourMomentum& p) {
+    return onShell(mass, p.data()[1], p.data()[2], p.data()[3]);
+}
+
+// Builds one event. Lepton numbers follow Lepton's convention (+1 for positive charge),
+// so every decay conserves them.
+class EventBuilder {
+private:
+    const EventGenerator::Config& config_;
+    Random rng_;
+    std::vector<std::shared_ptr<Particle>> finalState_;
+
+    std::array<double, 3> isotropic(double magnitude) {
+        double cosTheta = rng_.uniform(-1.0, 1.0), phi = rng_.uniform(0.0, 2.0 * pi);
+        double sinTheta = std::sqrt(std::max(0.0, 1.0 - cosTheta * cosTheta));
+        return {magnitude * sinTheta * std::cos(phi), magnitude * sinTheta * std::sin(phi), magnitude * cosTheta};
+    }
+
+    FourMomentum primaryMomentum(double mass) {
+        double pt = rng_.exponential(config_.meanPt);
+        double eta = rng_.uniform(-config_.maxAbsEta, config_.maxAbsEta);
+        double phi = rng_.uniform(0.0, 2.0 * pi);
+        return onShell(mass, pt * std::cos(phi), pt * std::sin(phi), pt * std::sinh(eta));
+    }
+
+    // Isotropic decay in the parent rest frame, boosted back to the lab
+    std::pair<FourMomentum, FourMomentum> twoBody(const FourMomentum& parent, double parentMass, double m1, double m2) {
+        double M2 = parentMass * parentMass;
+        double pStar = std::sqrt(std::max(0.0, (M2 - (m1 + m2) * (m1 + m2)) * (M2 - (m1 - m2) * (m1 - m2)))) / (2.0 * parentMass);
+        std::array<double, 3> d = isotropic(pStar);
+        std::array<double, 3> beta = parent.boostVector();
+        LorentzBoost toLab(beta[0], beta[1], beta[2]);
+        FourMomentum first = toLab.apply(onShell(m1, d[0], d[1], d[2]));
+        FourMomentum second = toLab.apply(onShell(m2, -d[0], -d[1], -d[2]));
+        return {onShell(m1, first), onShell(m2, second)};
+    }
+
+    std::shared_ptr<Particle> finalParticle(std::shared_ptr<Particle> particle) {
+        if (config_.catalogueDecayProducts) finalState_.push_back(particle);
+        return particle;
+    }
+
+    std::shared_ptr<Electron> electron(double charge, const FourMomentum& p) {
+        // Random shower profile over four layers; the last layer takes the remainder so
+        // the layers sum to E
+        double E = p.data()[0];
+        std::array<double, 4> weights;
+        double total = 0.0;
+        for (double& w : weights) total += (w = rng_.uniform(0.05, 1.0));
+        std::vector<double> layers(weights.size());
+        double deposited = 0.0;
+        for (std::size_t i = 0; i + 1 < layers.size(); i++) deposited += (layers[i] = E * weights[i] / total);
+        layers.back() = E - deposited;
+        return std::make_shared<Electron>(charge, 0.5, p, layers);
+    }
+
+    std::shared_ptr<Particle> neutrino(int leptonNumber, const FourMomentum& p) {
+        return std::make_shared<Neutrino>(0.0, 0.5, leptonNumber, p);
+    }
+
+    std::shared_ptr<Particle> quark(ParticleId id, const FourMomentum& p) {
+        static const char* colours[] = {"Red", "Green", "Blue"};
+        static const char* anticolours[] = {"Anti-Red", "Anti-Green", "Anti-Blue"};
+        std::size_t colour = rng_.next() % 3;
+        bool anti = static_cast<std::size_t>(id) % 2 == 1;  // Anti-flavours follow their flavour
+        return std::make_shared<Quark>(id, anti ? anticolours[colour] : colours[colour], p);
+    }
+
+    // Charged lepton of the given flavour (Electron, Muon or Tau); taus are decayed
+    std::shared_ptr<Particle> chargedLepton(ParticleId id, double charge, const FourMomentum& p) {
+        if (id == ParticleId::Electron) return finalParticle(electron(charge, p));
+        if (id == ParticleId::Muon) return finalParticle(std::make_shared<Muon>(charge, 0.5, p, rng_.chance(0.8)));
+        return tau(charge, p);
+    }
+
+    // tau -> l nu nu, generated as tau -> l + (nu nu). The nu-nu mass density rises
+    // linearly from zero, which also keeps the pair away from the ill-conditioned
+    // massless limit when it is boosted.
+    std::shared_ptr<Particle> tau(double charge, const FourMomentum& p) {
+        auto tau = std::make_shared<Tau>(charge, 0.5, p);
+        ParticleId flavour = rng_.chance(0.5) ? ParticleId::Electron : ParticleId::Muon;
+        double tauMass = massOf(ParticleId::Tau), leptonMass = massOf(flavour);
+        double pairMass = (tauMass - leptonMass) * std::sqrt(rng_.uniform());
+        auto [lepton, pair] = twoBody(p, tauMass, leptonMass, pairMass);
+        std::vector<std::shared_ptr<Particle>> products{chargedLepton(flavour, charge, lepton)};
+        if (pairMass > 0.0) {
+            auto [nu1, nu2] = twoBody(pair, pairMass, 0.0, 0.0);
+            products.push_back(finalParticle(neutrino(1, nu1)));
+            products.push_back(finalParticle(neutrino(-1, nu2)));
+        }
+        tau->setDecayProducts(products);
+        return tau;
+    }
+
+    ParticleId leptonFlavour() {
+        static constexpr ParticleId flavours[] = {ParticleId::Electron, ParticleId::Muon, ParticleId::Tau};
+        return flavours[rng_.next() % 3];
+    }
+
+    std::shared_ptr<Particle> wBoson() {
+        bool positive = rng_.chance(0.5);
+        ParticleId id = positive ? ParticleId::WPlus : ParticleId::WMinus;
+        FourMomentum p = primaryMomentum(massOf(id));
+        auto w = std::make_shared<Boson>(id, p);
+        ParticleId flavour = leptonFlavour();
+        auto [lepton, nu] = twoBody(p, massOf(id), massOf(flavour), 0.0);
+        w->addDecayProduct(chargedLepton(flavour, positive ? 1.0 : -1.0, lepton));
+        w->addDecayProduct(finalParticle(neutrino(positive ? -1 : 1, nu)));
+        return w;
+    }
+
+    std::shared_ptr<Particle> zBoson() {
+        FourMomentum p = primaryMomentum(massOf(ParticleId::Z0));
+        auto z = std::make_shared<Boson>(ParticleId::Z0, p);
+        if (rng_.chance(0.2)) {
+            auto [nu, antiNu] = twoBody(p, massOf(ParticleId::Z0), 0.0, 0.0);
+            z->addDecayProduct(finalParticle(neutrino(1, nu)));
+            z->addDecayProduct(finalParticle(neutrino(-1, antiNu)));
+            return z;
+        }
+        ParticleId flavour = leptonFlavour();
+        auto [minus, plus] = twoBody(p, massOf(ParticleId::Z0), massOf(flavour), massOf(flavour));
+        z->addDecayProduct(chargedLepton(flavour, -1.0, minus));
+        z->addDecayProduct(chargedLepton(flavour, 1.0, plus));
+        return z;
+    }
+
+    std::shared_ptr<Particle> higgs() {
+        FourMomentum p = primaryMomentum(massOf(ParticleId::Higgs));
+        auto h = std::make_shared<Boson>(ParticleId::Higgs, p);
+        if (rng_.chance(0.85)) {
+            auto [b, antiB] = twoBody(p, massOf(ParticleId::Higgs), massOf(ParticleId::Bottom), massOf(ParticleId::Bottom));
+            h->addDecayProduct(finalParticle(quark(ParticleId::Bottom, b)));
+            h->addDecayProduct(finalParticle(quark(ParticleId::AntiBottom, antiB)));
+        } else {
+            auto [minus, plus] = twoBody(p, massOf(ParticleId::Higgs), massOf(ParticleId::Tau), massOf(ParticleId::Tau));
+            h->addDecayProduct(tau(-1.0, minus));
+            h->addDecayProduct(tau(1.0, plus));
+        }
+        return h;
+    }
+
+    ParticleId quarkFlavour() {
+        // Light flavours dominate; top is rare
+        static constexpr std::array<double, 6> weights = {0.3, 0.3, 0.15, 0.1, 0.1, 0.05};
+        static constexpr ParticleId flavours[] = {ParticleId::Up, ParticleId::Down, ParticleId::Strange,
+                                                  ParticleId::Charm, ParticleId::Bottom, ParticleId::Top};
+        ParticleId id = flavours[rng_.pick(weights)];
+        return rng_.chance(0.5) ? particleProperties(id).antiparticle : id;
+    }
+
+public:
+    EventBuilder(const EventGenerator::Config& config, std::uint64_t event)
+        : config_(config), rng_(mix(config.seed ^ mix(event + 0x9e3779b97f4a7c15ULL))) {}
+
+    std::vector<std::shared_ptr<Particle>> build() {
+        std::vector<std::shared_ptr<Particle>> particles;
+        auto repeat = [&](double mean, auto&& make) {
+            for (unsigned i = 0, n = rng_.poisson(mean); i < n; i++) particles.push_back(make());
+        };
+        // Primaries are catalogued themselves, so they bypass finalParticle
+        repeat(config_.quarks, [&] {
+            ParticleId id = quarkFlavour();
+            return quark(id, primaryMomentum(massOf(id)));
+        });
+        repeat(config_.electrons, [&] {
+            return std::shared_ptr<Particle>(electron(rng_.chance(0.5) ? 1.0 : -1.0, primaryMomentum(massOf(ParticleId::Electron))));
+        });
+        repeat(config_.muons, [&] {
+            return std::shared_ptr<Particle>(std::make_shared<Muon>(rng_.chance(0.5) ? 1.0 : -1.0, 0.5, primaryMomentum(massOf(ParticleId::Muon)), rng_.chance(0.8)));
+        });
+        repeat(config_.taus, [&] { return tau(rng_.chance(0.5) ? 1.0 : -1.0, primaryMomentum(massOf(ParticleId::Tau))); });
+        repeat(config_.neutrinos, [&] { return neutrino(rng_.chance(0.5) ? 1 : -1, primaryMomentum(0.0)); });
+        repeat(config_.wBosons, [&] { return wBoson(); });
+        repeat(config_.zBosons, [&] { return zBoson(); });
+        repeat(config_.higgsBosons, [&] { return higgs(); });
+        particles.insert(particles.end(), finalState_.begin(), finalState_.end());
+        return particles;
+    }
+};
+
+} // namespace
+
+std::vector<std::shared_ptr<Particle>> EventGenerator::generateEvent(std::uint64_t event) const {
+    return EventBuilder(config_, event).build();
+}
+
+std::size_t EventGenerator::fill(ParticleCatalogue& catalogue, std::uint64_t firstEvent, std::size_t events) const {
+    // Events are generated in batches so only one batch of particles waits to be catalogued
+    const std::size_t eventsPerBlock = 256;
+    const std::size_t eventsPerBatch = 256 * eventsPerBlock;
+    ParallelExecutor executor(config_.threads);
+    std::size_t added = 0;
+    for (std::size_t batchStart = 0; batchStart < events; batchStart += eventsPerBatch) {
+        std::size_t batchEvents = std::min(eventsPerBatch, events - batchStart);
+        std::vector<std::vector<std::shared_ptr<Particle>>> blocks(ParallelExecutor::blockCount(batchEvents, eventsPerBlock));
+        executor.forEachRange(batchEvents, [&](std::size_t begin, std::size_t end, std::size_t block) {
+            ValidationScope scope = catalogue.validationScope();
+            for (std::size_t e = begin; e < end; e++) {
+                std::vector<std::shared_ptr<Particle>> particles = generateEvent(firstEvent + batchStart + e);
+                blocks[block].insert(blocks[block].end(), std::make_move_iterator(particles.begin()), std::make_move_iterator(particles.end()));
+            }
+        }, eventsPerBlock);
+        for (auto& block : blocks) {
+            for (auto& particle : block) catalogue.addParticle(particle);
+            added += block.size();
+            block.clear();
+        }
+    }
+    return added;
+}
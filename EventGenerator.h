@@ -0,0 +1,59 @@
+#ifndef EVENT_GENERATOR_H
+#define EVENT_GENERATOR_H
+
+#include "Particle.h"
+#include "ParticleCatalogue.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// Seeded generator of synthetic, physically consistent events for load tests. Every
+// particle is on shell, Electron calorimeter layers add up to E, and decays conserve
+// four-momentum:
+//   W -> l nu,  Z -> l+ l- / nu nu,  Higgs -> b b / tau+ tau-,  tau -> (e|mu) nu nu
+//
+// Each event draws from its own random stream derived from (seed, event number), so an
+// event is identical whichever thread generates it and however many threads run.
+class EventGenerator {
+public:
+    struct Config {
+        std::uint64_t seed = 1;
+
+        // Mean number of each primary particle per event; counts are Poisson distributed
+        double quarks = 4.0;
+        double electrons = 1.0;
+        double muons = 1.0;
+        double taus = 0.3;
+        double neutrinos = 0.5;
+        double wBosons = 0.2;
+        double zBosons = 0.2;
+        double higgsBosons = 0.05;
+
+        double meanPt = 20000.0;  // MeV; transverse momenta are exponentially distributed
+        double maxAbsEta = 2.5;   // Primaries are uniform in pseudorapidity and azimuth
+
+        // Also catalogue the final-state decay products (leptons, neutrinos, b quarks) after
+        // the primaries of each event; they stay reachable through their parents either way
+        bool catalogueDecayProducts = false;
+
+        unsigned threads = 0;  // 0 selects the hardware concurrency
+    };
+
+    EventGenerator() = default;
+    explicit EventGenerator(Config config) : config_(config) {}
+
+    const Config& getConfig() const { return config_; }
+
+    // Catalogue rows of one event: primaries, then final-state decay products when configured
+    std::vector<std::shared_ptr<Particle>> generateEvent(std::uint64_t event) const;
+
+    // Generates events [firstEvent, firstEvent + events) in parallel, under the catalogue's
+    // validation policy, and adds them in event order; returns the number of particles added
+    std::size_t fill(ParticleCatalogue& catalogue, std::uint64_t firstEvent, std::size_t events) const;
+
+private:
+    Config config_;
+};
+
+#endif // EVENT_GENERATOR_H
@@ -0,0 +1,285 @@
+#include "EventStream.h"
+#include "BoundedQueue.h"
+#include <array>
+#include <charconv>
+#include <chrono>
+#include <cmath>
+#include <exception>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string_view>
+#include <thread>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+using TypeNames = std::shared_ptr<const std::vector<std::string>>;
+
+// Chunks carry a snapshot of the type-name table so downstream threads never share
+// mutable state with the reader; the table is only copied when a new type appears.
+struct Chunk {
+    std::vector<StreamParticle> particles;
+    TypeNames typeNames;
+};
+
+double secondsSince(Clock::time_point start) {
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+std::string_view trim(std::string_view field) {
+    while (!field.empty() && (field.front() == ' ' || field.front() == '\t')) field.remove_prefix(1);
+    while (!field.empty() && (field.back() == ' ' || field.back() == '\t' || field.back() == '\r')) field.remove_suffix(1);
+    return field;
+}
+
+void splitCsv(std::string_view line, std::vector<std::string_view>& fields) {
+    fields.clear();
+    std::size_t start = 0;
+    while (true) {
+        std::size_t comma = line.find(',', start);
+        fields.push_back(trim(line.substr(start, comma == std::string_view::npos ? std::string_view::npos : comma - start)));
+        if (comma == std::string_view::npos) break;
+        start = comma + 1;
+    }
+}
+
+template<typename T>
+T parseNumber(std::string_view field, std::size_t lineNumber) {
+    if (!field.empty() && field.front() == '+') field.remove_prefix(1);
+    T value{};
+    auto result = std::from_chars(field.data(), field.data() + field.size(), value);
+    if (result.ec != std::errc() || result.ptr != field.data() + field.size()) {
+        throw std::runtime_error("Malformed number '" + std::string(field) + "' on line " + std::to_string(lineNumber) + " of the event stream.");
+    }
+    return value;
+}
+
+class CsvParticleReader {
+private:
+    enum Column { Event, Type, Energy, Px, Py, Pz, Charge, Spin, ColumnCount };
+
+    std::istream& input_;
+    std::array<int, ColumnCount> columns_;
+    std::size_t lineNumber_ = 0;
+    std::string line_;
+    std::vector<std::string_view> fields_;
+    std::unordered_map<std::string, std::uint16_t> typeIds_;
+    TypeNames typeNames_ = std::make_shared<const std::vector<std::string>>();
+
+    std::uint16_t internType(std::string_view name) {
+        auto it = typeIds_.find(std::string(name));
+        if (it != typeIds_.end()) return it->second;
+        auto names = std::make_shared<std::vector<std::string>>(*typeNames_);
+        std::uint16_t id = static_cast<std::uint16_t>(names->size());
+        names->emplace_back(name);
+        typeIds_.emplace(std::string(name), id);
+        typeNames_ = std::move(names);
+        return id;
+    }
+
+public:
+    explicit CsvParticleReader(std::istream& input) : input_(input) {
+        columns_.fill(-1);
+        if (!std::getline(input_, line_)) {
+            throw std::runtime_error("Event stream is empty: missing CSV header.");
+        }
+        lineNumber_ = 1;
+        splitCsv(line_, fields_);
+        static const std::array<std::string_view, ColumnCount> names = {"event", "type", "E", "px", "py", "pz", "charge", "spin"};
+        for (std::size_t i = 0; i < fields_.size(); i++) {
+            for (int c = 0; c < ColumnCount; c++) {
+                if (fields_[i] == names[c]) columns_[c] = static_cast<int>(i);
+            }
+        }
+        for (Column required : {Type, Energy, Px, Py, Pz}) {
+            if (columns_[required] < 0) {
+                throw std::runtime_error("Event stream header lacks the '" + std::string(names[required]) + "' column.");
+            }
+        }
+    }
+
+    // Fills chunk with up to maxParticles particles; returns false at end of input
+    bool read(Chunk& chunk, std::size_t maxParticles) {
+        chunk.particles.clear();
+        while (chunk.particles.size() < maxParticles && std::getline(input_, line_)) {
+            lineNumber_++;
+            if (trim(line_).empty()) continue;
+            splitCsv(line_, fields_);
+            auto field = [&](Column c) -> std::string_view {
+                if (columns_[c] < 0) return {};
+                if (columns_[c] >= static_cast<int>(fields_.size())) {
+                    throw std::runtime_error("Too few fields on line " + std::to_string(lineNumber_) + " of the event stream.");
+                }
+                return fields_[columns_[c]];
+            };
+            StreamParticle particle;
+            particle.event = columns_[Event] < 0 ? 0 : parseNumber<std::uint64_t>(field(Event), lineNumber_);
+            particle.E = parseNumber<double>(field(Energy), lineNumber_);
+            particle.px = parseNumber<double>(field(Px), lineNumber_);
+            particle.py = parseNumber<double>(field(Py), lineNumber_);
+            particle.pz = parseNumber<double>(field(Pz), lineNumber_);
+            particle.charge = columns_[Charge] < 0 ? 0.0 : parseNumber<double>(field(Charge), lineNumber_);
+            particle.spin = columns_[Spin] < 0 ? 0.0 : parseNumber<double>(field(Spin), lineNumber_);
+            particle.typeId = internType(field(Type));
+            chunk.particles.push_back(particle);
+        }
+        chunk.typeNames = typeNames_;
+        return !chunk.particles.empty();
+    }
+};
+
+// Shared error slot: the first failure closes every queue so all stages wind down
+class PipelineControl {
+private:
+    std::vector<BoundedQueue<Chunk>*> queues_;
+    std::exception_ptr error_;
+    std::mutex mutex_;
+
+public:
+    explicit PipelineControl(std::vector<BoundedQueue<Chunk>*> queues) : queues_(std::move(queues)) {}
+
+    void fail(std::exception_ptr error) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!error_) error_ = error;
+        }
+        for (auto* queue : queues_) queue->close();
+    }
+
+    void rethrowIfFailed() {
+        if (error_) std::rethrow_exception(error_);
+    }
+};
+
+// Runs body(chunk) for every chunk of input, forwarding survivors to output when given
+template<typename Body>
+std::thread startStage(StageStats& stats, PipelineControl& control, BoundedQueue<Chunk>& input, BoundedQueue<Chunk>* output, Body body) {
+    return std::thread([&stats, &control, &input, output, body]() mutable {
+        auto started = Clock::now();
+        try {
+            Chunk chunk;
+            while (input.pop(chunk)) {
+                auto busy = Clock::now();
+                stats.chunks++;
+                stats.particlesIn += chunk.particles.size();
+                body(chunk);
+                stats.particlesOut += chunk.particles.size();
+                stats.busySeconds += secondsSince(busy);
+                if (output && !output->push(std::move(chunk))) break;
+            }
+        } catch (...) {
+            control.fail(std::current_exception());
+        }
+        if (output) output->close();
+        stats.wallSeconds = secondsSince(started);
+    });
+}
+
+} // namespace
+
+StreamSummary EventStreamPipeline::run(const std::string& path) const {
+    if (path == "-") return run(std::cin);
+    std::ifstream input(path);
+    if (!input) {
+        throw std::runtime_error("Cannot open event stream: " + path);
+    }
+    return run(input);
+}
+
+StreamSummary EventStreamPipeline::run(std::istream& input) const {
+    StreamSummary summary;
+    summary.stages.resize(4);
+    StageStats& readStats = summary.stages[0];
+    readStats.name = "read";
+    summary.stages[1].name = "validate";
+    summary.stages[2].name = "filter";
+    summary.stages[3].name = "aggregate";
+
+    BoundedQueue<Chunk> parsed(config_.queueCapacity), validated(config_.queueCapacity), filtered(config_.queueCapacity);
+    PipelineControl control({&parsed, &validated, &filtered});
+
+    std::thread reader([&]() {
+        auto started = Clock::now();
+        try {
+            CsvParticleReader csv(input);
+            std::uint64_t lastEvent = 0;
+            while (true) {
+                auto busy = Clock::now();
+                Chunk chunk;
+                chunk.particles.reserve(config_.chunkSize);
+                if (!csv.read(chunk, config_.chunkSize)) break;
+                for (const StreamParticle& particle : chunk.particles) {
+                    if (summary.particlesRead == 0 || particle.event != lastEvent) summary.events++;
+                    lastEvent = particle.event;
+                    summary.particlesRead++;
+                }
+                readStats.chunks++;
+                readStats.particlesIn += chunk.particles.size();
+                readStats.particlesOut += chunk.particles.size();
+                readStats.busySeconds += secondsSince(busy);
+                if (!parsed.push(std::move(chunk))) break;
+            }
+        } catch (...) {
+            control.fail(std::current_exception());
+        }
+        parsed.close();
+        readStats.wallSeconds = secondsSince(started);
+    });
+
+    const Config& config = config_;
+    std::thread validator = startStage(summary.stages[1], control, parsed, &validated, [&summary, &config](Chunk& chunk) {
+        ValidationScope scope(config.validationMode, config.validationReport);
+        std::size_t kept = 0;
+        for (const StreamParticle& p : chunk.particles) {
+            bool finite = std::isfinite(p.E) && std::isfinite(p.px) && std::isfinite(p.py) && std::isfinite(p.pz);
+            if (finite && FourMomentum::unchecked(p.E, p.px, p.py, p.pz).validate()) {
+                chunk.particles[kept++] = p;
+            }
+        }
+        summary.rejected += chunk.particles.size() - kept;
+        chunk.particles.resize(kept);
+    });
+
+    const auto& filter = config_.filter;
+    std::thread filterer = startStage(summary.stages[2], control, validated, &filtered, [&summary, &filter](Chunk& chunk) {
+        if (!filter) return;
+        std::size_t kept = 0;
+        const std::vector<std::string>& names = *chunk.typeNames;
+        for (const StreamParticle& p : chunk.particles) {
+            if (filter(p, names[p.typeId])) chunk.particles[kept++] = p;
+        }
+        summary.filteredOut += chunk.particles.size() - kept;
+        chunk.particles.resize(kept);
+    });
+
+    double totalE = 0.0, totalPx = 0.0, totalPy = 0.0, totalPz = 0.0;
+    std::vector<std::size_t> counts;
+    TypeNames typeNames;
+    std::thread aggregator = startStage(summary.stages[3], control, filtered, nullptr, [&](Chunk& chunk) {
+        if (counts.size() < chunk.typeNames->size()) counts.resize(chunk.typeNames->size(), 0);
+        for (const StreamParticle& p : chunk.particles) {
+            totalE += p.E;
+            totalPx += p.px;
+            totalPy += p.py;
+            totalPz += p.pz;
+            counts[p.typeId]++;
+        }
+        typeNames = chunk.typeNames;
+    });
+
+    reader.join();
+    validator.join();
+    filterer.join();
+    aggregator.join();
+    control.rethrowIfFailed();
+
+    // Rounding can leave the sum of valid rows slightly spacelike; it is not a row to check
+    summary.totalFourMomentum = FourMomentum::unchecked(totalE, totalPx, totalPy, totalPz);
+    for (std::size_t id = 0; id < counts.size(); id++) {
+        if (counts[id] > 0) summary.particleCounts[(*typeNames)[id]] = counts[id];
+    }
+    return summary;
+}
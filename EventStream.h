@@ -0,0 +1,75 @@
+#ifndef EVENT_STREAM_H
+#define EVENT_STREAM_H
+
+#include "FourMomentum.h"
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <istream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// One particle as it flows through the streaming pipeline. Values are kept raw so
+// that the validation stage, not the parser, decides what is physical.
+struct StreamParticle {
+    std::uint64_t event;
+    double E, px, py, pz;
+    double charge;
+    double spin;
+    std::uint16_t typeId;  // Index into StreamSummary::typeNames
+};
+
+struct StageStats {
+    std::string name;
+    std::size_t chunks = 0;
+    std::size_t particlesIn = 0;
+    std::size_t particlesOut = 0;
+    double busySeconds = 0.0;   // Time spent working, excluding queue waits
+    double wallSeconds = 0.0;   // Lifetime of the stage thread
+
+    double throughput() const { return busySeconds > 0.0 ? particlesIn / busySeconds : 0.0; }
+};
+
+struct StreamSummary {
+    FourMomentum totalFourMomentum;
+    std::unordered_map<std::string, std::size_t> particleCounts;
+    std::size_t events = 0;      // Distinct consecutive event ids seen by the reader
+    std::size_t particlesRead = 0;
+    std::size_t rejected = 0;    // Non-finite or failed validation
+    std::size_t filteredOut = 0;
+    std::vector<StageStats> stages;
+};
+
+// Reads particles in chunks and pushes them through validate -> filter -> aggregate
+// stages, each on its own thread, connected by bounded queues. At most about
+// (stages + 3 * queueCapacity) chunks are alive at once, whatever the input size.
+//
+// Input is CSV with a header row. Columns are matched by name and unknown columns are
+// ignored: "type", "E", "px", "py", "pz" are required; "event", "charge", "spin" are optional.
+class EventStreamPipeline {
+public:
+    struct Config {
+        std::size_t chunkSize = 65536;    // Particles per chunk
+        std::size_t queueCapacity = 4;    // Chunks buffered between two stages
+        // Policy for the E >= |p| check (FourMomentum::validate). Failing rows are rejected;
+        // Strict also logs and fails the run. nullptr selects Validation::processReport().
+        ValidationMode validationMode = ValidationMode::CountOnly;
+        ValidationReport* validationReport = nullptr;
+        // Keep all when empty; called on the filter thread with the particle's type name
+        std::function<bool(const StreamParticle&, const std::string& type)> filter;
+    };
+
+    EventStreamPipeline() = default;
+    explicit EventStreamPipeline(Config config) : config_(std::move(config)) {}
+
+    StreamSummary run(std::istream& input) const;
+
+    // "-" reads standard input
+    StreamSummary run(const std::string& path) const;
+
+private:
+    Config config_;
+};
+
+#endif // EVENT_STREAM_H
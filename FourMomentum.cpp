@@ -1,45 +1,183 @@
 #include "FourMomentum.h"
+#include "LorentzTransform.h"
 
-FourMomentum FourMomentum::operator+(const FourMomentum& other) const {
-    return FourMomentum(components[0] + other.components[0],
-                        components[1] + other.components[1],
-                        components[2] + other.components[2],
-                        components[3] + other.components[3]);
+void FourMomentum::reportInconsistency(double E, double p) {
+    PARTICLE_COUNT(FourMomentumInvalid);
+    if (!Validation::fail(ValidationIssue::EnergyBelowMomentum, {}, p, E)) return;
+    std::cerr << "Validation Error: Energy (" << E << ") is less than the magnitude of momentum (" << p << ")." << std::endl;
+    throw std::invalid_argument("Energy-momentum inconsistency: E must be greater than or equal to the magnitude of p.");
 }
 
-FourMomentum FourMomentum::operator-(const FourMomentum& other) const {
-    return FourMomentum(components[0] - other.components[0],
-                        components[1] - other.components[1],
-                        components[2] - other.components[2],
-                        components[3] - other.components[3]);
+void FourMomentum::adjustForPhysicalConsistency(double expectedMass) {
+    double currentMass = invariantMass();
+    if (std::abs(currentMass - expectedMass) > 1e-4) {
+        double factor = expectedMass / currentMass;
+        for (int i = 1; i < 4; i++) {
+            components[i] *= factor;
+        }
+        components[0] = std::sqrt(components[1]*components[1] + components[2]*components[2] + components[3]*components[3] + expectedMass*expectedMass);
+    }
+}
+
+std::array<double, 3> FourMomentum::boostVector() const {
+    if (components[0] <= 0.0) {
+        throw std::invalid_argument("Boost vector requires positive energy.");
+    }
+    return {components[1] / components[0], components[2] / components[0], components[3] / components[0]};
 }
 
-double FourMomentum::operator*(const FourMomentum& other) const {
-    return components[0] * other.components[0] - 
-           (components[1] * other.components[1] + 
-            components[2] * other.components[2] + 
-            components[3] * other.components[3]);
+FourMomentum FourMomentum::boost(double bx, double by, double bz) const {
+    return LorentzBoost(bx, by, bz).apply(*this);
 }
 
-FourMomentum& FourMomentum::operator+=(const FourMomentum& other) {
-    for (int i = 0; i < 4; i++) {
-        components[i] += other.components[i];
+FourMomentum FourMomentum::boostToRestFrameOf(const FourMomentum& frame) const {
+    return LorentzBoost::toRestFrameOf(frame).apply(*this);
+}
+
+FourMomentum FourMomentum::rotateX(double angle) const {
+    return Rotation3::aboutX(angle).apply(*this);
+}
+
+FourMomentum FourMomentum::rotateY(double angle) const {
+    return Rotation3::aboutY(angle).apply(*this);
+}
+
+FourMomentum FourMomentum::rotateZ(double angle) const {
+    return Rotation3::aboutZ(angle).apply(*this);
+}
+
+FourMomentum FourMomentum::rotate(double ax, double ay, double az, double angle) const {
+    return Rotation3::aboutAxis(ax, ay, az, angle).apply(*this);
+}
+
+void FourMomentum::addBatch(const FourMomentum* a, const FourMomentum* b, FourMomentum* out, std::size_t n) {
+    for (std::size_t i = 0; i < n; i++) {
+#if defined(FOURMOMENTUM_USE_AVX)
+        _mm256_store_pd(out[i].components.data(), _mm256_add_pd(_mm256_load_pd(a[i].components.data()), _mm256_load_pd(b[i].components.data())));
+#elif defined(FOURMOMENTUM_USE_SSE2)
+        _mm_store_pd(&out[i].components[0], _mm_add_pd(_mm_load_pd(&a[i].components[0]), _mm_load_pd(&b[i].components[0])));
+        _mm_store_pd(&out[i].components[2], _mm_add_pd(_mm_load_pd(&a[i].components[2]), _mm_load_pd(&b[i].components[2])));
+#else
+        for (int k = 0; k < 4; k++) {
+            out[i].components[k] = a[i].components[k] + b[i].components[k];
+        }
+#endif
     }
-    validate();
-    return *this;
 }
 
-bool FourMomentum::operator!=(const FourMomentum& other) const {
-    return !std::equal(components.begin(), components.end(), other.components.begin());
+void FourMomentum::subtractBatch(const FourMomentum* a, const FourMomentum* b, FourMomentum* out, std::size_t n) {
+    for (std::size_t i = 0; i < n; i++) {
+#if defined(FOURMOMENTUM_USE_AVX)
+        _mm256_store_pd(out[i].components.data(), _mm256_sub_pd(_mm256_load_pd(a[i].components.data()), _mm256_load_pd(b[i].components.data())));
+#elif defined(FOURMOMENTUM_USE_SSE2)
+        _mm_store_pd(&out[i].components[0], _mm_sub_pd(_mm_load_pd(&a[i].components[0]), _mm_load_pd(&b[i].components[0])));
+        _mm_store_pd(&out[i].components[2], _mm_sub_pd(_mm_load_pd(&a[i].components[2]), _mm_load_pd(&b[i].components[2])));
+#else
+        for (int k = 0; k < 4; k++) {
+            out[i].components[k] = a[i].components[k] - b[i].components[k];
+        }
+#endif
+    }
 }
 
-void FourMomentum::adjustForPhysicalConsistency(double expectedMass) {
-    double currentMass = invariantMass();
-    if (std::abs(currentMass - expectedMass) > 1e-4) {
-        double factor = expectedMass / currentMass;
-        for (int i = 1; i < 4; i++) {
-            components[i] *= factor;
+// The contraction kernels transpose blocks of four-vectors into E/px/py/pz lanes so that
+// every lane does useful work, instead of doing one horizontal sum per vector.
+void FourMomentum::dotBatch(const FourMomentum* a, const FourMomentum* b, double* out, std::size_t n) {
+    std::size_t i = 0;
+#if defined(FOURMOMENTUM_USE_AVX)
+    for (; i + 4 <= n; i += 4) {
+        __m256d ta0 = _mm256_unpacklo_pd(_mm256_load_pd(a[i].data()), _mm256_load_pd(a[i + 1].data()));
+        __m256d ta1 = _mm256_unpackhi_pd(_mm256_load_pd(a[i].data()), _mm256_load_pd(a[i + 1].data()));
+        __m256d ta2 = _mm256_unpacklo_pd(_mm256_load_pd(a[i + 2].data()), _mm256_load_pd(a[i + 3].data()));
+        __m256d ta3 = _mm256_unpackhi_pd(_mm256_load_pd(a[i + 2].data()), _mm256_load_pd(a[i + 3].data()));
+        __m256d tb0 = _mm256_unpacklo_pd(_mm256_load_pd(b[i].data()), _mm256_load_pd(b[i + 1].data()));
+        __m256d tb1 = _mm256_unpackhi_pd(_mm256_load_pd(b[i].data()), _mm256_load_pd(b[i + 1].data()));
+        __m256d tb2 = _mm256_unpacklo_pd(_mm256_load_pd(b[i + 2].data()), _mm256_load_pd(b[i + 3].data()));
+        __m256d tb3 = _mm256_unpackhi_pd(_mm256_load_pd(b[i + 2].data()), _mm256_load_pd(b[i + 3].data()));
+        __m256d result = _mm256_mul_pd(_mm256_permute2f128_pd(ta0, ta2, 0x20), _mm256_permute2f128_pd(tb0, tb2, 0x20));  // E
+        result = _mm256_sub_pd(result, _mm256_mul_pd(_mm256_permute2f128_pd(ta1, ta3, 0x20), _mm256_permute2f128_pd(tb1, tb3, 0x20)));  // px
+        result = _mm256_sub_pd(result, _mm256_mul_pd(_mm256_permute2f128_pd(ta0, ta2, 0x31), _mm256_permute2f128_pd(tb0, tb2, 0x31)));  // py
+        result = _mm256_sub_pd(result, _mm256_mul_pd(_mm256_permute2f128_pd(ta1, ta3, 0x31), _mm256_permute2f128_pd(tb1, tb3, 0x31)));  // pz
+        _mm256_storeu_pd(out + i, result);
+    }
+#elif defined(FOURMOMENTUM_USE_SSE2)
+    for (; i + 2 <= n; i += 2) {
+        __m128d a0 = _mm_load_pd(&a[i].components[0]), a1 = _mm_load_pd(&a[i].components[2]);
+        __m128d a2 = _mm_load_pd(&a[i + 1].components[0]), a3 = _mm_load_pd(&a[i + 1].components[2]);
+        __m128d b0 = _mm_load_pd(&b[i].components[0]), b1 = _mm_load_pd(&b[i].components[2]);
+        __m128d b2 = _mm_load_pd(&b[i + 1].components[0]), b3 = _mm_load_pd(&b[i + 1].components[2]);
+        __m128d result = _mm_mul_pd(_mm_unpacklo_pd(a0, a2), _mm_unpacklo_pd(b0, b2));  // E
+        result = _mm_sub_pd(result, _mm_mul_pd(_mm_unpackhi_pd(a0, a2), _mm_unpackhi_pd(b0, b2)));  // px
+        result = _mm_sub_pd(result, _mm_mul_pd(_mm_unpacklo_pd(a1, a3), _mm_unpacklo_pd(b1, b3)));  // py
+        result = _mm_sub_pd(result, _mm_mul_pd(_mm_unpackhi_pd(a1, a3), _mm_unpackhi_pd(b1, b3)));  // pz
+        _mm_storeu_pd(out + i, result);
+    }
+#endif
+    for (; i < n; i++) {
+        out[i] = a[i] * b[i];
+    }
+}
+
+void FourMomentum::invariantMassBatch(const FourMomentum* p, double* out, std::size_t n) {
+    std::size_t i = 0;
+#if defined(FOURMOMENTUM_USE_AVX)
+    for (; i + 4 <= n; i += 4) {
+        __m256d t0 = _mm256_unpacklo_pd(_mm256_load_pd(p[i].data()), _mm256_load_pd(p[i + 1].data()));
+        __m256d t1 = _mm256_unpackhi_pd(_mm256_load_pd(p[i].data()), _mm256_load_pd(p[i + 1].data()));
+        __m256d t2 = _mm256_unpacklo_pd(_mm256_load_pd(p[i + 2].data()), _mm256_load_pd(p[i + 3].data()));
+        __m256d t3 = _mm256_unpackhi_pd(_mm256_load_pd(p[i + 2].data()), _mm256_load_pd(p[i + 3].data()));
+        __m256d E = _mm256_permute2f128_pd(t0, t2, 0x20);
+        __m256d px = _mm256_permute2f128_pd(t1, t3, 0x20);
+        __m256d py = _mm256_permute2f128_pd(t0, t2, 0x31);
+        __m256d pz = _mm256_permute2f128_pd(t1, t3, 0x31);
+        __m256d massSquared = _mm256_sub_pd(_mm256_mul_pd(E, E),
+            _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(px, px), _mm256_mul_pd(py, py)), _mm256_mul_pd(pz, pz)));
+        _mm256_storeu_pd(out + i, _mm256_sqrt_pd(_mm256_max_pd(massSquared, _mm256_setzero_pd())));
+    }
+#elif defined(FOURMOMENTUM_USE_SSE2)
+    for (; i + 2 <= n; i += 2) {
+        __m128d lo0 = _mm_load_pd(&p[i].components[0]), hi0 = _mm_load_pd(&p[i].components[2]);
+        __m128d lo1 = _mm_load_pd(&p[i + 1].components[0]), hi1 = _mm_load_pd(&p[i + 1].components[2]);
+        __m128d E = _mm_unpacklo_pd(lo0, lo1), px = _mm_unpackhi_pd(lo0, lo1);
+        __m128d py = _mm_unpacklo_pd(hi0, hi1), pz = _mm_unpackhi_pd(hi0, hi1);
+        __m128d massSquared = _mm_sub_pd(_mm_mul_pd(E, E),
+            _mm_add_pd(_mm_add_pd(_mm_mul_pd(px, px), _mm_mul_pd(py, py)), _mm_mul_pd(pz, pz)));
+        _mm_storeu_pd(out + i, _mm_sqrt_pd(_mm_max_pd(massSquared, _mm_setzero_pd())));
+    }
+#endif
+    for (; i < n; i++) {
+        out[i] = p[i].invariantMass();
+    }
+}
+
+FourMomentum FourMomentum::sum(const FourMomentum* p, std::size_t n) {
+    FourMomentum total;
+#if defined(FOURMOMENTUM_USE_AVX)
+    // Two accumulators hide the add latency
+    __m256d acc0 = _mm256_setzero_pd(), acc1 = _mm256_setzero_pd();
+    std::size_t i = 0;
+    for (; i + 2 <= n; i += 2) {
+        acc0 = _mm256_add_pd(acc0, _mm256_load_pd(p[i].data()));
+        acc1 = _mm256_add_pd(acc1, _mm256_load_pd(p[i + 1].data()));
+    }
+    if (i < n) {
+        acc0 = _mm256_add_pd(acc0, _mm256_load_pd(p[i].data()));
+    }
+    _mm256_store_pd(total.components.data(), _mm256_add_pd(acc0, acc1));
+#elif defined(FOURMOMENTUM_USE_SSE2)
+    __m128d lo = _mm_setzero_pd(), hi = _mm_setzero_pd();
+    for (std::size_t i = 0; i < n; i++) {
+        lo = _mm_add_pd(lo, _mm_load_pd(&p[i].components[0]));
+        hi = _mm_add_pd(hi, _mm_load_pd(&p[i].components[2]));
+    }
+    _mm_store_pd(&total.components[0], lo);
+    _mm_store_pd(&total.components[2], hi);
+#else
+    for (std::size_t i = 0; i < n; i++) {
+        for (int k = 0; k < 4; k++) {
+            total.components[k] += p[i].components[k];
         }
-        components[0] = std::sqrt(components[1]*components[1] + components[2]*components[2] + components[3]*components[3] + expectedMass*expectedMass);
     }
+#endif
+    return total;
 }
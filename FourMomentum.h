@@ -1,29 +1,58 @@
 #ifndef FOURMOMENTUM_H
 #define FOURMOMENTUM_H
 
-#include <vector>
+#include <array>
+#include <cstddef>
 #include <cmath>
 #include <stdexcept>
+#include <type_traits>
+#include <algorithm>
 #include <iostream> // Added for logging
+#include "InstrumentationHooks.h"
+#include "Validation.h"
 
-class FourMomentum {
+// Pick the widest vector unit available at compile time; the scalar path is always available.
+#if defined(__AVX__)
+#include <immintrin.h>
+#define FOURMOMENTUM_USE_AVX 1
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define FOURMOMENTUM_USE_SSE2 1
+#endif
+
+class alignas(32) FourMomentum {
 private:
-    std::vector<double> components;  // Stores the four-momentum components [E, px, py, pz]
+    std::array<double, 4> components;  // Stores the four-momentum components [E, px, py, pz]
+
+    static void reportInconsistency(double E, double p);  // Acts on the thread's ValidationMode
+
+    friend class LorentzBoost;  // Batch kernels write components in place
+    friend class Rotation3;
 
 public:
-    FourMomentum() : components(4, 0.0) {}  // Default constructor initializes four-vector to zero
+    FourMomentum() : components{0.0, 0.0, 0.0, 0.0} {}  // Default constructor initializes four-vector to zero
     FourMomentum(double E, double px, double py, double pz) : components{E, px, py, pz} {
         validate();
     }
 
-    // Validate energy-momentum relation
-    void validate() const {
+    // Skips validate(), e.g. for sums that rounding may leave slightly spacelike
+    static FourMomentum unchecked(double E, double px, double py, double pz) {
+        FourMomentum result;
+        result.components = {E, px, py, pz};
+        return result;
+    }
+
+    // Validate energy-momentum relation; failures are handled by the current validation policy.
+    // Returns false when E < |p|, so callers running without Strict can drop the value.
+    bool validate() const {
+        PARTICLE_COUNT(FourMomentumValidated);
         double E = components[0];
-        double p = sqrt(components[1] * components[1] + components[2] * components[2] + components[3] * components[3]);
+        double p = std::sqrt(components[1] * components[1] + components[2] * components[2] + components[3] * components[3]);
         if (E < p) {
-            std::cerr << "Validation Error: Energy (" << E << ") is less than the magnitude of momentum (" << p << ")." << std::endl;
-            throw std::invalid_argument("Energy-momentum inconsistency: E must be greater than or equal to the magnitude of p.");
+            reportInconsistency(E, p);
+            return false;
         }
+        return true;
     }
 
     double getComponent(int index) const {
@@ -33,13 +62,11 @@ public:
         return components[index];
     }
 
+    // Raw access to the [E, px, py, pz] block, 32-byte aligned
+    const double* data() const { return components.data(); }
+
     double invariantMass() const {
-        double E = components[0];
-        double px = components[1];
-        double py = components[2];
-        double pz = components[3];
-        double massSquared = E * E - (px * px + py * py + pz * pz);
-        return std::sqrt(std::max(0.0, massSquared));
+        return std::sqrt(std::max(0.0, *this * *this));
     }
 
     FourMomentum operator+(const FourMomentum& other) const;
@@ -48,6 +75,97 @@ public:
     FourMomentum& operator+=(const FourMomentum& other);
     bool operator!=(const FourMomentum& other) const;
     void adjustForPhysicalConsistency(double expectedMass); // Adjusts the components to ensure physical consistency based on expected mass
+
+    // Lorentz transformations; see LorentzTransform.h for batch versions
+    std::array<double, 3> boostVector() const;  // Velocity p/E of this four-momentum
+    FourMomentum boost(double bx, double by, double bz) const;
+    FourMomentum boostToRestFrameOf(const FourMomentum& frame) const;
+    FourMomentum rotateX(double angle) const;
+    FourMomentum rotateY(double angle) const;
+    FourMomentum rotateZ(double angle) const;
+    FourMomentum rotate(double ax, double ay, double az, double angle) const;
+
+    // Batch kernels over contiguous arrays of n four-vectors. Results are not validated:
+    // sums of physical momenta are physical, and differences may legitimately be spacelike.
+    static void addBatch(const FourMomentum* a, const FourMomentum* b, FourMomentum* out, std::size_t n);
+    static void subtractBatch(const FourMomentum* a, const FourMomentum* b, FourMomentum* out, std::size_t n);
+    static void dotBatch(const FourMomentum* a, const FourMomentum* b, double* out, std::size_t n);
+    static void invariantMassBatch(const FourMomentum* p, double* out, std::size_t n);
+    static FourMomentum sum(const FourMomentum* p, std::size_t n);
 };
 
+static_assert(std::is_trivially_copyable<FourMomentum>::value, "FourMomentum must stay trivially copyable");
+static_assert(sizeof(FourMomentum) == 4 * sizeof(double), "FourMomentum must have a fixed [E, px, py, pz] layout");
+
+// The element-wise operators are small enough that they belong inline with the callers' loops.
+// Like the batch kernels they do not validate: sums of physical momenta are physical, and
+// differences may legitimately be spacelike.
+inline FourMomentum FourMomentum::operator+(const FourMomentum& other) const {
+    FourMomentum result;
+#if defined(FOURMOMENTUM_USE_AVX)
+    _mm256_store_pd(result.components.data(), _mm256_add_pd(_mm256_load_pd(components.data()), _mm256_load_pd(other.components.data())));
+#elif defined(FOURMOMENTUM_USE_SSE2)
+    _mm_store_pd(&result.components[0], _mm_add_pd(_mm_load_pd(&components[0]), _mm_load_pd(&other.components[0])));
+    _mm_store_pd(&result.components[2], _mm_add_pd(_mm_load_pd(&components[2]), _mm_load_pd(&other.components[2])));
+#else
+    for (int i = 0; i < 4; i++) {
+        result.components[i] = components[i] + other.components[i];
+    }
+#endif
+    return result;
+}
+
+inline FourMomentum FourMomentum::operator-(const FourMomentum& other) const {
+    FourMomentum result;
+#if defined(FOURMOMENTUM_USE_AVX)
+    _mm256_store_pd(result.components.data(), _mm256_sub_pd(_mm256_load_pd(components.data()), _mm256_load_pd(other.components.data())));
+#elif defined(FOURMOMENTUM_USE_SSE2)
+    _mm_store_pd(&result.components[0], _mm_sub_pd(_mm_load_pd(&components[0]), _mm_load_pd(&other.components[0])));
+    _mm_store_pd(&result.components[2], _mm_sub_pd(_mm_load_pd(&components[2]), _mm_load_pd(&other.components[2])));
+#else
+    for (int i = 0; i < 4; i++) {
+        result.components[i] = components[i] - other.components[i];
+    }
+#endif
+    return result;
+}
+
+// Minkowski product with metric (+, -, -, -)
+inline double FourMomentum::operator*(const FourMomentum& other) const {
+#if defined(FOURMOMENTUM_USE_AVX)
+    __m256d prod = _mm256_mul_pd(_mm256_load_pd(components.data()), _mm256_load_pd(other.components.data()));
+    prod = _mm256_mul_pd(prod, _mm256_setr_pd(1.0, -1.0, -1.0, -1.0));
+    __m128d half = _mm_add_pd(_mm256_castpd256_pd128(prod), _mm256_extractf128_pd(prod, 1));
+    return _mm_cvtsd_f64(_mm_add_sd(half, _mm_unpackhi_pd(half, half)));
+#elif defined(FOURMOMENTUM_USE_SSE2)
+    __m128d lo = _mm_mul_pd(_mm_load_pd(&components[0]), _mm_load_pd(&other.components[0]));
+    __m128d hi = _mm_mul_pd(_mm_load_pd(&components[2]), _mm_load_pd(&other.components[2]));
+    __m128d half = _mm_sub_pd(_mm_mul_pd(lo, _mm_setr_pd(1.0, -1.0)), hi);
+    return _mm_cvtsd_f64(_mm_add_sd(half, _mm_unpackhi_pd(half, half)));
+#else
+    return components[0] * other.components[0] -
+           (components[1] * other.components[1] +
+            components[2] * other.components[2] +
+            components[3] * other.components[3]);
+#endif
+}
+
+inline FourMomentum& FourMomentum::operator+=(const FourMomentum& other) {
+#if defined(FOURMOMENTUM_USE_AVX)
+    _mm256_store_pd(components.data(), _mm256_add_pd(_mm256_load_pd(components.data()), _mm256_load_pd(other.components.data())));
+#elif defined(FOURMOMENTUM_USE_SSE2)
+    _mm_store_pd(&components[0], _mm_add_pd(_mm_load_pd(&components[0]), _mm_load_pd(&other.components[0])));
+    _mm_store_pd(&components[2], _mm_add_pd(_mm_load_pd(&components[2]), _mm_load_pd(&other.components[2])));
+#else
+    for (int i = 0; i < 4; i++) {
+        components[i] += other.components[i];
+    }
+#endif
+    return *this;
+}
+
+inline bool FourMomentum::operator!=(const FourMomentum& other) const {
+    return components != other.components;
+}
+
 #endif // FOURMOMENTUM_H
@@ -0,0 +1,155 @@
+#include "Instrumentation.h"
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace {
+
+struct TimerSlot {
+    std::atomic<std::uint64_t> count{0}, totalNs{0}, maxNs{0};
+    std::array<std::atomic<std::uint64_t>, TimerStats::bucketCount> buckets{};
+};
+
+struct alignas(64) Slot {
+    std::array<std::atomic<std::uint64_t>, counterCount> counters{};
+    std::array<TimerSlot, timerCount> timers{};
+};
+
+struct Registry {
+    std::mutex mutex;
+    std::vector<std::unique_ptr<Slot>> slots;
+    std::vector<Slot*> idle;  // Slots of threads that have exited
+};
+
+Registry& registryInstance() {
+    static Registry registry;
+    return registry;
+}
+
+// Claims a slot for the calling thread and returns it to the idle list at thread exit
+struct SlotLease {
+    Slot* slot;
+
+    SlotLease() {
+        Registry& registry = registryInstance();
+        std::lock_guard<std::mutex> lock(registry.mutex);
+        if (!registry.idle.empty()) {
+            slot = registry.idle.back();
+            registry.idle.pop_back();
+        } else {
+            registry.slots.push_back(std::make_unique<Slot>());
+            slot = registry.slots.back().get();
+        }
+    }
+
+    ~SlotLease() {
+        Registry& registry = registryInstance();
+        std::lock_guard<std::mutex> lock(registry.mutex);
+        registry.idle.push_back(slot);
+    }
+};
+
+Slot& slot() {
+    thread_local SlotLease lease;
+    return *lease.slot;
+}
+
+// Single writer per slot, so no read-modify-write is needed
+void bump(std::atomic<std::uint64_t>& value, std::uint64_t n) {
+    value.store(value.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+}
+
+void appendField(std::string& out, std::string_view name, std::uint64_t value) {
+    out += '"';
+    out += name;
+    out += "\": ";
+    out += std::to_string(value);
+}
+
+} // namespace
+
+std::string InstrumentationSnapshot::toJson() const {
+    std::string out = Instrumentation::enabled ? "{\"enabled\": true, \"counters\": {" : "{\"enabled\": false, \"counters\": {";
+    for (std::size_t c = 0; c < counterCount; c++) {
+        if (c) out += ", ";
+        appendField(out, counterName(static_cast<Counter>(c)), counters[c]);
+    }
+    out += "}, \"timers\": {";
+    for (std::size_t t = 0; t < timerCount; t++) {
+        const TimerStats& stats = timers[t];
+        if (t) out += ", ";
+        out += '"';
+        out += timerName(static_cast<Timer>(t));
+        out += "\": {";
+        appendField(out, "count", stats.count);
+        out += ", ";
+        appendField(out, "total_ns", stats.totalNs);
+        out += ", ";
+        appendField(out, "max_ns", stats.maxNs);
+        out += ", ";
+        appendField(out, "p50_ns", stats.quantileNs(0.5));
+        out += ", ";
+        appendField(out, "p99_ns", stats.quantileNs(0.99));
+        out += ", \"buckets\": [";
+        std::size_t used = TimerStats::bucketCount;
+        while (used > 0 && stats.buckets[used - 1] == 0) used--;
+        for (std::size_t b = 0; b < used; b++) {
+            if (b) out += ", ";
+            out += std::to_string(stats.buckets[b]);
+        }
+        out += "]}";
+    }
+    out += "}}";
+    return out;
+}
+
+void Instrumentation::count(Counter counter, std::uint64_t n) {
+    bump(slot().counters[static_cast<std::size_t>(counter)], n);
+}
+
+void Instrumentation::record(Timer timer, std::uint64_t ns) {
+    TimerSlot& t = slot().timers[static_cast<std::size_t>(timer)];
+    bump(t.count, 1);
+    bump(t.totalNs, ns);
+    if (ns > t.maxNs.load(std::memory_order_relaxed)) t.maxNs.store(ns, std::memory_order_relaxed);
+    bump(t.buckets[TimerStats::bucketOf(ns)], 1);
+}
+
+InstrumentationSnapshot Instrumentation::snapshot() {
+    InstrumentationSnapshot result;
+    Registry& registry = registryInstance();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    for (const auto& s : registry.slots) {
+        for (std::size_t c = 0; c < counterCount; c++) result.counters[c] += s->counters[c].load(std::memory_order_relaxed);
+        for (std::size_t t = 0; t < timerCount; t++) {
+            const TimerSlot& from = s->timers[t];
+            TimerStats& to = result.timers[t];
+            to.count += from.count.load(std::memory_order_relaxed);
+            to.totalNs += from.totalNs.load(std::memory_order_relaxed);
+            to.maxNs = std::max(to.maxNs, from.maxNs.load(std::memory_order_relaxed));
+            for (std::size_t b = 0; b < TimerStats::bucketCount; b++) to.buckets[b] += from.buckets[b].load(std::memory_order_relaxed);
+        }
+    }
+    return result;
+}
+
+void Instrumentation::reset() {
+    Registry& registry = registryInstance();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    for (const auto& s : registry.slots) {
+        for (auto& c : s->counters) c.store(0, std::memory_order_relaxed);
+        for (TimerSlot& t : s->timers) {
+            t.count.store(0, std::memory_order_relaxed);
+            t.totalNs.store(0, std::memory_order_relaxed);
+            t.maxNs.store(0, std::memory_order_relaxed);
+            for (auto& b : t.buckets) b.store(0, std::memory_order_relaxed);
+        }
+    }
+}
+
+std::uint64_t Instrumentation::nowNs() {
+    auto elapsed = std::chrono::steady_clock::now().time_since_epoch();
+    return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+}
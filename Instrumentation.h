@@ -0,0 +1,58 @@
+#ifndef INSTRUMENTATION_H
+#define INSTRUMENTATION_H
+
+#include "InstrumentationHooks.h"
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Reporting side of the hot-path counters and timers; see InstrumentationHooks.h for the
+// recording macros.
+
+// Durations of one timer. Bucket b counts durations in [2^b, 2^(b+1)) ns (bucket 0 also
+// takes anything shorter than 1 ns); the last bucket is open-ended.
+struct TimerStats {
+    static constexpr std::size_t bucketCount = 40;
+
+    std::uint64_t count = 0;
+    std::uint64_t totalNs = 0;
+    std::uint64_t maxNs = 0;
+    std::array<std::uint64_t, bucketCount> buckets{};
+
+    static std::size_t bucketOf(std::uint64_t ns) {
+        std::size_t bucket = 0;
+        while (ns > 1 && bucket + 1 < bucketCount) {
+            ns >>= 1;
+            bucket++;
+        }
+        return bucket;
+    }
+
+    // Upper bound of the bucket holding quantile q in [0, 1], capped at maxNs; 0 without samples
+    std::uint64_t quantileNs(double q) const {
+        if (count == 0) return 0;
+        std::uint64_t rank = static_cast<std::uint64_t>(q * static_cast<double>(count - 1)) + 1, seen = 0;
+        for (std::size_t b = 0; b < bucketCount; b++) {
+            seen += buckets[b];
+            if (seen >= rank) return b + 1 < bucketCount ? std::min(std::uint64_t{2} << b, maxNs) : maxNs;
+        }
+        return maxNs;
+    }
+};
+
+// Totals over every thread at the time of the snapshot
+struct InstrumentationSnapshot {
+    std::array<std::uint64_t, counterCount> counters{};
+    std::array<TimerStats, timerCount> timers{};
+
+    std::uint64_t counter(Counter c) const { return counters[static_cast<std::size_t>(c)]; }
+    const TimerStats& timer(Timer t) const { return timers[static_cast<std::size_t>(t)]; }
+
+    // {"enabled": ..., "counters": {name: n, ...}, "timers": {name: {count, total_ns, max_ns,
+    // p50_ns, p99_ns, buckets: [...]}, ...}}; bucket lists drop their trailing zeros
+    std::string toJson() const;
+};
+
+#endif // INSTRUMENTATION_H
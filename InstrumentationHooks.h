@@ -0,0 +1,125 @@
+#ifndef INSTRUMENTATION_HOOKS_H
+#define INSTRUMENTATION_HOOKS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+// Recording side of Instrumentation.h, kept small because every particle header includes
+// it. Build with -DPARTICLE_INSTRUMENTATION=1 (CMake option PARTICLE_CATALOGUE_INSTRUMENTATION)
+// to enable the counters and timers; otherwise PARTICLE_COUNT and PARTICLE_TIME_SCOPE expand
+// to nothing and the snapshot API reports zeros.
+#ifndef PARTICLE_INSTRUMENTATION
+#define PARTICLE_INSTRUMENTATION 0
+#endif
+
+enum class Counter : std::uint8_t {
+    FourMomentumValidated,   // FourMomentum::validate calls
+    FourMomentumInvalid,     // ... that found E < |p|
+    QuarkConstructed,
+    LeptonConstructed,       // Lepton and its subclasses
+    BosonConstructed,
+    QuarkMassFlagged,        // Quark::validateMass outside tolerance
+    BosonMassFlagged,        // Boson::validateMass outside tolerance
+    CalorimeterMismatch,     // Electron layers not adding up to E, per particle or in a batch
+    ParticlesAdded,          // ParticleCatalogue::addParticle
+};
+
+constexpr std::size_t counterCount = 9;
+
+constexpr std::string_view counterName(Counter counter) {
+    switch (counter) {
+    case Counter::FourMomentumValidated: return "FourMomentumValidated";
+    case Counter::FourMomentumInvalid: return "FourMomentumInvalid";
+    case Counter::QuarkConstructed: return "QuarkConstructed";
+    case Counter::LeptonConstructed: return "LeptonConstructed";
+    case Counter::BosonConstructed: return "BosonConstructed";
+    case Counter::QuarkMassFlagged: return "QuarkMassFlagged";
+    case Counter::BosonMassFlagged: return "BosonMassFlagged";
+    case Counter::CalorimeterMismatch: return "CalorimeterMismatch";
+    case Counter::ParticlesAdded: return "ParticlesAdded";
+    }
+    return "Unknown";
+}
+
+enum class Timer : std::uint8_t {
+    GetTotalFourMomentum,
+    GetTotalFourMomentumParallel,
+    GetParticleCounts,
+    GetParticleCountsParallel,
+    SortParticles,
+    SortParticlesParallel,
+    FilterParticles,
+    FilterParticlesParallel,
+    ReconcileCalorimeters,
+    Clear,
+};
+
+constexpr std::size_t timerCount = 10;
+
+constexpr std::string_view timerName(Timer timer) {
+    switch (timer) {
+    case Timer::GetTotalFourMomentum: return "getTotalFourMomentum";
+    case Timer::GetTotalFourMomentumParallel: return "getTotalFourMomentumParallel";
+    case Timer::GetParticleCounts: return "getParticleCounts";
+    case Timer::GetParticleCountsParallel: return "getParticleCountsParallel";
+    case Timer::SortParticles: return "sortParticles";
+    case Timer::SortParticlesParallel: return "sortParticlesParallel";
+    case Timer::FilterParticles: return "filterParticles";
+    case Timer::FilterParticlesParallel: return "filterParticlesParallel";
+    case Timer::ReconcileCalorimeters: return "reconcileCalorimeters";
+    case Timer::Clear: return "clear";
+    }
+    return "Unknown";
+}
+
+struct InstrumentationSnapshot;  // Instrumentation.h
+
+// Every thread that records gets its own slot, so recording is a relaxed load and store on
+// a cache line no other thread writes. A thread's slot is kept, with its counts, when the
+// thread exits and is handed to the next new thread, so short-lived workers such as
+// ParallelExecutor's do not grow the registry. The registry lives in Instrumentation.cpp.
+class Instrumentation {
+public:
+    static constexpr bool enabled = PARTICLE_INSTRUMENTATION != 0;
+
+    static void count(Counter counter, std::uint64_t n = 1);
+    static void record(Timer timer, std::uint64_t ns);
+
+    // Totals over every thread at the time of the snapshot
+    static InstrumentationSnapshot snapshot();
+    // Zeroes every slot. Counts recorded concurrently with the reset may be lost.
+    static void reset();
+
+    // Monotonic clock used by ScopedTimer
+    static std::uint64_t nowNs();
+};
+
+// Records the lifetime of the scope into a timer
+class ScopedTimer {
+private:
+    Timer timer_;
+    std::uint64_t start_;
+
+public:
+    explicit ScopedTimer(Timer timer) : timer_(timer), start_(Instrumentation::nowNs()) {}
+
+    ~ScopedTimer() { Instrumentation::record(timer_, Instrumentation::nowNs() - start_); }
+
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+};
+
+#if PARTICLE_INSTRUMENTATION
+#define PARTICLE_INSTRUMENTATION_CONCAT_(a, b) a##b
+#define PARTICLE_INSTRUMENTATION_CONCAT(a, b) PARTICLE_INSTRUMENTATION_CONCAT_(a, b)
+#define PARTICLE_COUNT(counter) Instrumentation::count(Counter::counter)
+#define PARTICLE_COUNT_N(counter, n) Instrumentation::count(Counter::counter, (n))
+#define PARTICLE_TIME_SCOPE(timer) ScopedTimer PARTICLE_INSTRUMENTATION_CONCAT(particleTimer_, __LINE__)(Timer::timer)
+#else
+#define PARTICLE_COUNT(counter) ((void)0)
+#define PARTICLE_COUNT_N(counter, n) ((void)0)
+#define PARTICLE_TIME_SCOPE(timer) ((void)0)
+#endif
+
+#endif // INSTRUMENTATION_HOOKS_H
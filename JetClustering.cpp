@@ -0,0 +1,407 @@
+#include "JetClustering.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <queue>
+#include <stdexcept>
+#include <utility>
+
+namespace {
+
+constexpr double pi = 3.14159265358979323846;
+constexpr double twoPi = 2.0 * pi;
+constexpr double maxRapidity = 1e5;      // Assigned to particles along the beam axis
+constexpr double minKt2 = 1e-300;        // Keeps kT^-2 finite for particles with pT = 0
+
+double rapidityOf(const FourMomentum& p) {
+    double E = p.data()[0], pz = p.data()[3];
+    if (E - pz <= 0.0) return maxRapidity;
+    if (E + pz <= 0.0) return -maxRapidity;
+    return std::clamp(0.5 * std::log((E + pz) / (E - pz)), -maxRapidity, maxRapidity);
+}
+
+double phiOf(const FourMomentum& p) {
+    double phi = std::atan2(p.data()[2], p.data()[1]);
+    if (phi < 0.0) phi += twoPi;
+    return phi >= twoPi ? phi - twoPi : phi;
+}
+
+class Clusterer {
+private:
+    struct PseudoJet {
+        FourMomentum p;
+        double y, phi, mom;
+        double nnDist;
+        int nn;
+        int firstFollower, nextFollower, previousFollower;  // Particles whose nn is this one
+        int leaf;
+        std::size_t leafPosition;
+        unsigned version;
+        bool active;
+        std::vector<std::size_t> constituents;
+    };
+
+    struct Candidate {
+        double distance;
+        int index;
+        unsigned version;
+        bool operator>(const Candidate& other) const {
+            return distance != other.distance ? distance > other.distance : index > other.index;
+        }
+    };
+
+    // kd-tree cell over (rapidity, phi). The cells are split once, at the medians of the input
+    // particles, and then stay fixed; merged pseudojets go into the leaf whose cell holds them.
+    // Each node tracks its active particle count and their largest nnDist, so nearest() skips
+    // empty cells and closerTo() skips cells whose particles all have nearer neighbours.
+    struct Node {
+        double yLo, yHi, phiLo, phiHi;
+        int parent = -1, left = -1, right = -1;
+        bool splitY = true;
+        double split = 0.0;
+        std::size_t size = 0;
+        double maxNnDist = -1.0;  // Below any distance while the cell is empty
+    };
+
+    // Leaf contents, with coordinates copied so scans stay within the leaf's own memory
+    struct Member {
+        int index;
+        double y, phi, nnDist;
+    };
+
+    static constexpr std::size_t leafSize = 16;
+    // Cell distances are rounded separately from particle distances; the slack keeps a reverse
+    // search from skipping a particle whose nnDist ties its cell distance
+    static constexpr double boundSlack = 1.0 + 1e-12;
+
+    double R2_, invR2_;
+    double exponent_;
+    std::vector<PseudoJet> jets_;
+    std::priority_queue<Candidate, std::vector<Candidate>, std::greater<Candidate>> heap_;
+    std::vector<Node> nodes_;
+    std::vector<std::vector<Member>> members_;  // By node; empty for inner nodes
+    std::vector<std::pair<int, double>> found_;
+
+    double momentumFactor(const FourMomentum& p) const {
+        double kt2 = std::max(minKt2, p.data()[1] * p.data()[1] + p.data()[2] * p.data()[2]);
+        return exponent_ == 0.0 ? 1.0 : exponent_ > 0.0 ? kt2 : 1.0 / kt2;
+    }
+
+    static double azimuthalGap(double dphi) {
+        dphi = std::fabs(dphi);
+        return dphi > pi ? twoPi - dphi : dphi;
+    }
+
+    static double distance(const PseudoJet& a, const Member& b) {
+        double dy = a.y - b.y;
+        double dphi = azimuthalGap(a.phi - b.phi);
+        return dy * dy + dphi * dphi;
+    }
+
+    // Lower bound on the distance from a to any particle in the cell; phi wraps around
+    double cellDistance(const PseudoJet& a, const Node& cell) const {
+        double dy = a.y < cell.yLo ? cell.yLo - a.y : a.y > cell.yHi ? a.y - cell.yHi : 0.0;
+        double dphi = 0.0;
+        if (a.phi < cell.phiLo || a.phi > cell.phiHi) {
+            dphi = std::min(azimuthalGap(a.phi - cell.phiLo), azimuthalGap(a.phi - cell.phiHi));
+        }
+        return dy * dy + dphi * dphi;
+    }
+
+    // Splits the cell of order[begin, end) along its wider spread until leaves hold leafSize
+    int build(std::vector<int>& order, std::size_t begin, std::size_t end,
+              double yLo, double yHi, double phiLo, double phiHi, int parent) {
+        int node = static_cast<int>(nodes_.size());
+        nodes_.emplace_back();
+        Node& cell = nodes_.back();
+        cell.yLo = yLo;
+        cell.yHi = yHi;
+        cell.phiLo = phiLo;
+        cell.phiHi = phiHi;
+        cell.parent = parent;
+        if (end - begin <= leafSize) return node;
+
+        double yMin = jets_[order[begin]].y, yMax = yMin, phiMin = jets_[order[begin]].phi, phiMax = phiMin;
+        for (std::size_t i = begin + 1; i < end; i++) {
+            const PseudoJet& jet = jets_[order[i]];
+            yMin = std::min(yMin, jet.y);
+            yMax = std::max(yMax, jet.y);
+            phiMin = std::min(phiMin, jet.phi);
+            phiMax = std::max(phiMax, jet.phi);
+        }
+        if (yMax == yMin && phiMax == phiMin) return node;  // Coincident particles share a leaf
+        bool splitY = yMax - yMin >= phiMax - phiMin;
+        auto key = [&](int index) { return splitY ? jets_[index].y : jets_[index].phi; };
+        std::size_t mid = begin + (end - begin) / 2;
+        std::nth_element(order.begin() + begin, order.begin() + mid, order.begin() + end,
+                         [&](int a, int b) { return key(a) < key(b); });
+        double split = key(order[mid]);
+        nodes_[node].splitY = splitY;
+        nodes_[node].split = split;
+        int left = splitY ? build(order, begin, mid, yLo, split, phiLo, phiHi, node)
+                          : build(order, begin, mid, yLo, yHi, phiLo, split, node);
+        int right = splitY ? build(order, mid, end, split, yHi, phiLo, phiHi, node)
+                           : build(order, mid, end, yLo, yHi, split, phiHi, node);
+        nodes_[node].left = left;
+        nodes_[node].right = right;
+        return node;
+    }
+
+    // Recomputes the largest nnDist of a leaf and of the cells above it
+    void refreshBound(int leaf) {
+        double bound = -1.0;
+        for (const Member& member : members_[leaf]) bound = std::max(bound, member.nnDist);
+        nodes_[leaf].maxNnDist = bound;
+        for (int node = nodes_[leaf].parent; node >= 0; node = nodes_[node].parent) {
+            bound = std::max(nodes_[nodes_[node].left].maxNnDist, nodes_[nodes_[node].right].maxNnDist);
+            if (bound == nodes_[node].maxNnDist) break;
+            nodes_[node].maxNnDist = bound;
+        }
+    }
+
+    void resize(int leaf, int delta) {
+        for (int node = leaf; node >= 0; node = nodes_[node].parent) {
+            nodes_[node].size += delta;
+        }
+    }
+
+    int add(FourMomentum p, std::vector<std::size_t> constituents) {
+        int index = static_cast<int>(jets_.size());
+        double y = rapidityOf(p), phi = phiOf(p);
+        jets_.push_back({p, y, phi, momentumFactor(p), R2_, -1, -1, -1, -1, -1, 0, 0, true, std::move(constituents)});
+        return index;
+    }
+
+    void insert(int index) {
+        PseudoJet& jet = jets_[index];
+        int node = 0;
+        while (nodes_[node].left >= 0) {
+            double key = nodes_[node].splitY ? jet.y : jet.phi;
+            node = key < nodes_[node].split ? nodes_[node].left : nodes_[node].right;
+        }
+        jet.leaf = node;
+        jet.leafPosition = members_[node].size();
+        members_[node].push_back({index, jet.y, jet.phi, jet.nnDist});
+        resize(node, 1);
+    }
+
+    // Keep each particle on the follower list of its nn
+    void follow(int index) {
+        PseudoJet& jet = jets_[index];
+        if (jet.nn < 0) return;
+        PseudoJet& target = jets_[jet.nn];
+        jet.previousFollower = -1;
+        jet.nextFollower = target.firstFollower;
+        if (target.firstFollower >= 0) jets_[target.firstFollower].previousFollower = index;
+        target.firstFollower = index;
+    }
+
+    void unfollow(int index) {
+        PseudoJet& jet = jets_[index];
+        if (jet.nn < 0) return;
+        if (jet.previousFollower >= 0) {
+            jets_[jet.previousFollower].nextFollower = jet.nextFollower;
+        } else {
+            jets_[jet.nn].firstFollower = jet.nextFollower;
+        }
+        if (jet.nextFollower >= 0) jets_[jet.nextFollower].previousFollower = jet.previousFollower;
+    }
+
+    void remove(int index) {
+        unfollow(index);
+        PseudoJet& jet = jets_[index];
+        std::vector<Member>& members = members_[jet.leaf];
+        members[jet.leafPosition] = members.back();
+        jets_[members.back().index].leafPosition = jet.leafPosition;
+        members.pop_back();
+        jet.active = false;
+        resize(jet.leaf, -1);
+        refreshBound(jet.leaf);
+    }
+
+    void scanLeaf(int leaf, PseudoJet& jet, int index) {
+        for (const Member& other : members_[leaf]) {
+            if (other.index == index) continue;
+            double d = distance(jet, other);
+            if (d < jet.nnDist) {
+                jet.nnDist = d;
+                jet.nn = other.index;
+            }
+        }
+    }
+
+    // Nearer child first, so the search radius shrinks before the far side is tried. The
+    // jet's own leaf is scanned up front and skipped here.
+    void nearest(int node, PseudoJet& jet, int index) {
+        const Node& cell = nodes_[node];
+        if (cell.left < 0) {
+            if (node != jet.leaf) scanLeaf(node, jet, index);
+            return;
+        }
+        int first = cell.left, second = cell.right;
+        if ((cell.splitY ? jet.y : jet.phi) >= cell.split) std::swap(first, second);
+        if (nodes_[first].size > 0 && cellDistance(jet, nodes_[first]) < jet.nnDist) nearest(first, jet, index);
+        if (nodes_[second].size > 0 && cellDistance(jet, nodes_[second]) < jet.nnDist) nearest(second, jet, index);
+    }
+
+    void setNeighbour(int index, int nn, double nnDist) {
+        unfollow(index);
+        PseudoJet& jet = jets_[index];
+        jet.nn = nn;
+        jet.nnDist = nnDist;
+        follow(index);
+        members_[jet.leaf][jet.leafPosition].nnDist = nnDist;
+        refreshBound(jet.leaf);
+    }
+
+    void findNeighbour(int index) {
+        PseudoJet& jet = jets_[index];
+        int oldNn = jet.nn;
+        jet.nnDist = R2_;
+        jet.nn = -1;
+        scanLeaf(jet.leaf, jet, index);
+        nearest(0, jet, index);
+        int nn = jet.nn;
+        jet.nn = oldNn;  // Still on the old neighbour's follower list
+        setNeighbour(index, nn, jet.nnDist);
+    }
+
+    // Appends to found_ every other particle that is closer to jet than to its nn, with
+    // that distance
+    void closerTo(int node, const PseudoJet& jet, int index) {
+        const Node& cell = nodes_[node];
+        if (cellDistance(jet, cell) > cell.maxNnDist * boundSlack) return;
+        if (cell.left < 0) {
+            for (const Member& member : members_[node]) {
+                double d = distance(jet, member);
+                if (d < member.nnDist && member.index != index) found_.emplace_back(member.index, d);
+            }
+            return;
+        }
+        closerTo(cell.left, jet, index);
+        closerTo(cell.right, jet, index);
+    }
+
+    void push(int index) {
+        PseudoJet& jet = jets_[index];
+        double d = jet.nn < 0 ? jet.mom : std::min(jet.mom, jets_[jet.nn].mom) * jet.nnDist * invR2_;
+        heap_.push({d, index, ++jet.version});
+    }
+
+public:
+    Clusterer(const JetDefinition& definition, const std::vector<FourMomentum>& inputs)
+        : R2_(definition.R * definition.R), invR2_(1.0 / (definition.R * definition.R)),
+          exponent_(definition.algorithm == JetAlgorithm::AntiKt ? -1.0 : definition.algorithm == JetAlgorithm::Kt ? 1.0 : 0.0) {
+        jets_.reserve(2 * inputs.size());
+        for (std::size_t i = 0; i < inputs.size(); i++) add(inputs[i], {i});
+        std::vector<int> order(inputs.size());
+        for (std::size_t i = 0; i < order.size(); i++) order[i] = static_cast<int>(i);
+        constexpr double infinity = std::numeric_limits<double>::infinity();
+        nodes_.reserve(4 * (inputs.size() / leafSize + 1));
+        build(order, 0, order.size(), -infinity, infinity, 0.0, twoPi, -1);
+        members_.resize(nodes_.size());
+        for (int i = 0; i < static_cast<int>(jets_.size()); i++) insert(i);
+    }
+
+    std::vector<Jet> run(double ptMin) {
+        std::vector<Jet> result;
+        for (int i = 0; i < static_cast<int>(jets_.size()); i++) findNeighbour(i);
+        for (int i = 0; i < static_cast<int>(jets_.size()); i++) push(i);
+        std::vector<int> orphans;
+        while (!heap_.empty()) {
+            Candidate top = heap_.top();
+            heap_.pop();
+            PseudoJet& jet = jets_[top.index];
+            if (!jet.active || top.version != jet.version) continue;
+
+            int i = top.index, j = jet.nn, k = -1;
+            remove(i);
+            if (j >= 0) remove(j);
+
+            orphans.clear();
+            for (int gone : {i, j}) {
+                if (gone < 0) continue;
+                for (int m = jets_[gone].firstFollower; m >= 0; m = jets_[m].nextFollower) orphans.push_back(m);
+            }
+
+            if (j < 0) {
+                double pt = std::hypot(jets_[i].p.data()[1], jets_[i].p.data()[2]);
+                if (pt >= ptMin) {
+                    std::vector<std::size_t> constituents = std::move(jets_[i].constituents);
+                    std::sort(constituents.begin(), constituents.end());
+                    result.push_back({jets_[i].p, std::move(constituents)});
+                }
+            } else {
+                std::vector<std::size_t> constituents = std::move(jets_[i].constituents);
+                std::vector<std::size_t>& other = jets_[j].constituents;
+                if (constituents.size() < other.size()) constituents.swap(other);
+                constituents.insert(constituents.end(), other.begin(), other.end());
+                k = add(jets_[i].p + jets_[j].p, std::move(constituents));
+                insert(k);
+                findNeighbour(k);
+                push(k);
+            }
+            for (int m : orphans) {
+                findNeighbour(m);
+                push(m);
+            }
+
+            // The new pseudojet becomes the neighbour of particles it is closer to
+            if (k >= 0) {
+                found_.clear();
+                closerTo(0, jets_[k], k);
+                for (const auto& [m, d] : found_) {
+                    setNeighbour(m, k, d);
+                    push(m);
+                }
+            }
+        }
+        std::stable_sort(result.begin(), result.end(), [](const Jet& a, const Jet& b) { return a.pt() > b.pt(); });
+        return result;
+    }
+};
+
+} // namespace
+
+double Jet::pt() const {
+    return std::hypot(momentum.data()[1], momentum.data()[2]);
+}
+
+double Jet::rapidity() const {
+    return rapidityOf(momentum);
+}
+
+double Jet::phi() const {
+    return phiOf(momentum);
+}
+
+std::vector<Jet> JetClustering::cluster(const std::vector<FourMomentum>& inputs) const {
+    if (!(definition_.R > 0.0)) {
+        throw std::invalid_argument("Jet radius R must be positive.");
+    }
+    return Clusterer(definition_, inputs).run(definition_.ptMin);
+}
+
+std::vector<Jet> JetClustering::cluster(const ParticleCatalogue& catalogue, const std::vector<std::size_t>& rows) const {
+    const auto& particles = catalogue.getParticles();
+    std::vector<FourMomentum> inputs;
+    inputs.reserve(rows.size());
+    for (std::size_t row : rows) {
+        if (row >= particles.size()) {
+            throw std::out_of_range("Row out of range in JetClustering::cluster.");
+        }
+        inputs.push_back(particles[row]->getFourMomentum());
+    }
+    std::vector<Jet> jets = cluster(inputs);
+    for (Jet& jet : jets) {
+        for (std::size_t& constituent : jet.constituents) constituent = rows[constituent];
+        std::sort(jet.constituents.begin(), jet.constituents.end());
+    }
+    return jets;
+}
+
+std::vector<Jet> JetClustering::cluster(const ParticleCatalogue& catalogue) const {
+    std::vector<std::size_t> rows(catalogue.getTotalNumberOfParticles());
+    for (std::size_t row = 0; row < rows.size(); row++) rows[row] = row;
+    return cluster(catalogue, rows);
+}
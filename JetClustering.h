@@ -0,0 +1,53 @@
+#ifndef JET_CLUSTERING_H
+#define JET_CLUSTERING_H
+
+#include "FourMomentum.h"
+#include "ParticleCatalogue.h"
+#include <cstddef>
+#include <vector>
+
+// Generalised kT family: d_ij = min(kT_i^2p, kT_j^2p) * dR_ij^2 / R^2, d_iB = kT_i^2p with
+// p = -1 (anti-kT), 0 (Cambridge/Aachen) or 1 (kT)
+enum class JetAlgorithm { AntiKt, CambridgeAachen, Kt };
+
+struct JetDefinition {
+    JetAlgorithm algorithm = JetAlgorithm::AntiKt;
+    double R = 0.4;
+    double ptMin = 0.0;  // MeV; softer jets are left out of the result
+};
+
+struct Jet {
+    FourMomentum momentum;                  // E-scheme sum of the constituents
+    std::vector<std::size_t> constituents;  // Catalogue rows (or input indices), ascending
+
+    double pt() const;
+    double rapidity() const;
+    double phi() const;  // In [0, 2pi)
+    double mass() const { return momentum.invariantMass(); }
+};
+
+// Sequential recombination over (rapidity, phi). Each particle keeps its geometric nearest
+// neighbour, found in a kd-tree over (rapidity, phi) whose cells also carry the largest
+// neighbour distance inside them; candidate distances sit in a min-heap with lazy
+// invalidation. A recombination re-queries only the particles whose neighbour was merged
+// away and those the new pseudojet is now closer to, each an O(log N) tree search, so a
+// whole event takes O(N log N) on average instead of the naive N^3.
+class JetClustering {
+public:
+    JetClustering() = default;
+    explicit JetClustering(JetDefinition definition) : definition_(definition) {}
+
+    const JetDefinition& getDefinition() const { return definition_; }
+
+    // Jets in decreasing pT. A catalogue usually holds many events: pass the rows of one
+    std::vector<Jet> cluster(const ParticleCatalogue& catalogue, const std::vector<std::size_t>& rows) const;
+    std::vector<Jet> cluster(const ParticleCatalogue& catalogue) const;
+
+    // Constituents are indices into inputs
+    std::vector<Jet> cluster(const std::vector<FourMomentum>& inputs) const;
+
+private:
+    JetDefinition definition_;
+};
+
+#endif // JET_CLUSTERING_H
@@ -1,6 +1,7 @@
 #ifndef LEPTON_H
 #define LEPTON_H
 
+#include "CalorimeterStore.h"
 #include "Particle.h"
 #include <iostream>
 #include <vector>
@@ -16,18 +17,19 @@ protected:
     FourMomentum fourMomentum_;
 
 public:
-    Lepton(double charge, double spin, int leptonNumber, FourMomentum fourMomentum)
-        : charge_(charge), spin_(spin), leptonNumber_(leptonNumber), fourMomentum_(fourMomentum) {}
+    Lepton(double charge, double spin, int leptonNumber, const FourMomentum& fourMomentum)
+        : charge_(charge), spin_(spin), leptonNumber_(leptonNumber), fourMomentum_(fourMomentum) {
+        PARTICLE_COUNT(LeptonConstructed);
+    }
 
     virtual ~Lepton() {}
 
     double charge() const override { return charge_; }
     double spin() const override { return spin_; }
+    int getLeptonNumber() const override { return leptonNumber_; }
     FourMomentum getFourMomentum() const override { return fourMomentum_; }
-    virtual std::string getType() const override { return "Lepton"; }
-    virtual std::vector<std::shared_ptr<Particle>> decayProducts() const override {
-        return {}; // Default: no decay products for generic leptons
-    }
+    std::string_view getType() const override { return particleName(getId()); }
+    ParticleId getId() const override { return ParticleId::Lepton; }
 
     void print(bool detailed) const override {
         std::cout << std::fixed << std::setprecision(2);
@@ -40,9 +42,9 @@ public:
                   << ", px=" << getFourMomentum().getComponent(1)
                   << ", py=" << getFourMomentum().getComponent(2)
                   << ", pz=" << getFourMomentum().getComponent(3) << ")\n";
-        if (detailed && !decayProducts().empty()) {
+        if (detailed && !getDecayProducts().empty()) {
             std::cout << "Decays into    : ";
-            for (const auto& prod : decayProducts()) {
+            for (const auto& prod : getDecayProducts()) {
                 std::cout << prod->getType() << " ";
             }
             std::cout << "\n";
@@ -53,21 +55,43 @@ public:
 
 class Electron : public Lepton {
 private:
-    std::vector<double> calorimeterLayers;
+    std::vector<double> calorimeterLayers;     // Own copy, for electrons built from a vector
+    const CalorimeterStore* store_ = nullptr;  // Otherwise the layers live in a shared store
+    CalorimeterStore::Range layers_;
+    bool calorimeterChecked_ = true;  // False until reconcileCalorimeters() checks shared-store layers
+
+    friend class ParticleCatalogue;  // Writes back ParticleCatalogue::reconcileCalorimeters
 
 public:
-    Electron(double charge, double spin, FourMomentum fourMomentum, const std::vector<double>& layers)
+    Electron(double charge, double spin, const FourMomentum& fourMomentum, const std::vector<double>& layers)
         : Lepton(charge, spin, (charge > 0 ? 1 : -1), fourMomentum), calorimeterLayers(layers) {
         double totalCalorimeterEnergy = std::accumulate(layers.begin(), layers.end(), 0.0);
         if (std::abs(totalCalorimeterEnergy - fourMomentum_.getComponent(0)) > 1e-3) {  // Tightened tolerance
-            std::cerr << "Warning: Total calorimeter energy does not match electron's energy (" 
-                      << totalCalorimeterEnergy << " vs " << fourMomentum_.getComponent(0) << ")." << std::endl;
+            PARTICLE_COUNT(CalorimeterMismatch);
+            if (Validation::fail(ValidationIssue::CalorimeterMismatch, getType(), fourMomentum_.getComponent(0), totalCalorimeterEnergy)) {
+                std::cerr << "Warning: Total calorimeter energy does not match electron's energy ("
+                          << totalCalorimeterEnergy << " vs " << fourMomentum_.getComponent(0) << ")." << std::endl;
+            }
             // Adjust the energy component to match the sum of calorimeter layers.
             fourMomentum_.adjustForPhysicalConsistency(totalCalorimeterEnergy);
         }
     }
 
-    std::string getType() const override { return "Electron"; }
+    // Layers already appended to store, which must outlive the electron. The calorimeter
+    // check is deferred to a batch pass (CalorimeterStore::reconcile), so the momentum is
+    // kept as given until then.
+    Electron(double charge, double spin, const FourMomentum& fourMomentum, const CalorimeterStore& store, CalorimeterStore::Range layers)
+        : Lepton(charge, spin, (charge > 0 ? 1 : -1), fourMomentum), store_(&store), layers_(layers), calorimeterChecked_(false) {}
+
+    ParticleId getId() const override { return ParticleId::Electron; }
+
+    CalorimeterLayers getCalorimeterLayers() const {
+        return store_ ? store_->layers(layers_) : CalorimeterLayers(calorimeterLayers.data(), calorimeterLayers.size());
+    }
+
+    // Shared store holding the layers, or nullptr when the electron owns them
+    const CalorimeterStore* getCalorimeterStore() const { return store_; }
+    CalorimeterStore::Range getCalorimeterRange() const { return layers_; }
 };
 
 class Muon : public Lepton {
@@ -75,10 +99,10 @@ private:
     bool isIsolated_;
 
 public:
-    Muon(double charge, double spin, FourMomentum fourMomentum, bool isolated)
+    Muon(double charge, double spin, const FourMomentum& fourMomentum, bool isolated)
         : Lepton(charge, spin, (charge > 0 ? 1 : -1), fourMomentum), isIsolated_(isolated) {}
 
-    std::string getType() const override { return "Muon"; }
+    ParticleId getId() const override { return ParticleId::Muon; }
     bool isIsolated() const override { return isIsolated_; }
 };
 
@@ -86,18 +110,18 @@ class Tau : public Lepton {
 public:
     std::vector<std::shared_ptr<Particle>> decayProducts_;
 
-    Tau(double charge, double spin, FourMomentum fourMomentum)
+    Tau(double charge, double spin, const FourMomentum& fourMomentum)
         : Lepton(charge, spin, (charge > 0 ? 1 : -1), fourMomentum) {}
 
-    std::vector<std::shared_ptr<Particle>> decayProducts() const override {
-        return decayProducts_; // Use the renamed variable
-    }
-
     void setDecayProducts(const std::vector<std::shared_ptr<Particle>>& products) {
         decayProducts_ = products;
     }
 
-    std::string getType() const override { return "Tau"; }
+    const std::vector<std::shared_ptr<Particle>>& getDecayProducts() const override {
+        return decayProducts_;
+    }
+
+    ParticleId getId() const override { return ParticleId::Tau; }
 
     void print(bool detailed) const override {
         Lepton::print(detailed);
@@ -113,10 +137,10 @@ public:
 
 class Neutrino : public Lepton {
 public:
-    Neutrino(double charge, double spin, int leptonNumber, FourMomentum fourMomentum)
+    Neutrino(double charge, double spin, int leptonNumber, const FourMomentum& fourMomentum)
         : Lepton(charge, spin, leptonNumber, fourMomentum) {}
 
-    std::string getType() const override { return "Neutrino"; }
+    ParticleId getId() const override { return ParticleId::Neutrino; }
 
     void print(bool detailed) const override {
         Lepton::print(detailed);
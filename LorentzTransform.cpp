@@ -0,0 +1,233 @@
+#include "LorentzTransform.h"
+#include <cmath>
+#include <stdexcept>
+
+namespace {
+
+// Lane-wise kernels shared by the array-of-vectors and column entry points. Each vector
+// register holds the same component (E, px, py or pz) of several four-vectors.
+#if defined(FOURMOMENTUM_USE_AVX)
+using Lanes = __m256d;
+constexpr std::size_t laneCount = 4;
+inline Lanes splat(double x) { return _mm256_set1_pd(x); }
+inline Lanes loadLanes(const double* p) { return _mm256_loadu_pd(p); }
+inline void storeLanes(double* p, Lanes v) { _mm256_storeu_pd(p, v); }
+inline Lanes add(Lanes a, Lanes b) { return _mm256_add_pd(a, b); }
+inline Lanes mul(Lanes a, Lanes b) { return _mm256_mul_pd(a, b); }
+
+// 4x4 transpose between four [E, px, py, pz] rows and E/px/py/pz lanes; it is its own inverse
+inline void transpose(Lanes& r0, Lanes& r1, Lanes& r2, Lanes& r3) {
+    Lanes t0 = _mm256_unpacklo_pd(r0, r1), t1 = _mm256_unpackhi_pd(r0, r1);
+    Lanes t2 = _mm256_unpacklo_pd(r2, r3), t3 = _mm256_unpackhi_pd(r2, r3);
+    r0 = _mm256_permute2f128_pd(t0, t2, 0x20);
+    r1 = _mm256_permute2f128_pd(t1, t3, 0x20);
+    r2 = _mm256_permute2f128_pd(t0, t2, 0x31);
+    r3 = _mm256_permute2f128_pd(t1, t3, 0x31);
+}
+#elif defined(FOURMOMENTUM_USE_SSE2)
+using Lanes = __m128d;
+constexpr std::size_t laneCount = 2;
+inline Lanes splat(double x) { return _mm_set1_pd(x); }
+inline Lanes loadLanes(const double* p) { return _mm_loadu_pd(p); }
+inline void storeLanes(double* p, Lanes v) { _mm_storeu_pd(p, v); }
+inline Lanes add(Lanes a, Lanes b) { return _mm_add_pd(a, b); }
+inline Lanes mul(Lanes a, Lanes b) { return _mm_mul_pd(a, b); }
+#endif
+
+} // namespace
+
+LorentzBoost::LorentzBoost(double bx, double by, double bz) : bx_(bx), by_(by), bz_(bz) {
+    double beta2 = bx * bx + by * by + bz * bz;
+    if (!(beta2 < 1.0)) {
+        throw std::invalid_argument("Boost velocity must satisfy |beta| < 1.");
+    }
+    gamma_ = 1.0 / std::sqrt(1.0 - beta2);
+    gammaFactor_ = gamma_ * gamma_ / (1.0 + gamma_);
+}
+
+LorentzBoost LorentzBoost::toRestFrameOf(const FourMomentum& p) {
+    const double* c = p.data();
+    if (c[0] <= 0.0 || p * p <= 0.0) {
+        throw std::invalid_argument("Rest frame requires a timelike four-momentum with positive energy.");
+    }
+    return LorentzBoost(-c[1] / c[0], -c[2] / c[0], -c[3] / c[0]);
+}
+
+FourMomentum LorentzBoost::apply(const FourMomentum& p) const {
+    FourMomentum result = p;
+    apply(&result, 1);
+    return result;
+}
+
+void LorentzBoost::apply(FourMomentum* p, std::size_t n) const {
+    std::size_t i = 0;
+#if defined(FOURMOMENTUM_USE_AVX)
+    const Lanes bx = splat(bx_), by = splat(by_), bz = splat(bz_), g = splat(gamma_), gf = splat(gammaFactor_);
+    for (; i + 4 <= n; i += 4) {
+        Lanes E = _mm256_load_pd(p[i].components.data()), X = _mm256_load_pd(p[i + 1].components.data());
+        Lanes Y = _mm256_load_pd(p[i + 2].components.data()), Z = _mm256_load_pd(p[i + 3].components.data());
+        transpose(E, X, Y, Z);
+        Lanes bp = add(add(mul(bx, X), mul(by, Y)), mul(bz, Z));
+        Lanes k = add(mul(gf, bp), mul(g, E));
+        E = mul(g, add(E, bp));
+        X = add(X, mul(k, bx));
+        Y = add(Y, mul(k, by));
+        Z = add(Z, mul(k, bz));
+        transpose(E, X, Y, Z);
+        _mm256_store_pd(p[i].components.data(), E);
+        _mm256_store_pd(p[i + 1].components.data(), X);
+        _mm256_store_pd(p[i + 2].components.data(), Y);
+        _mm256_store_pd(p[i + 3].components.data(), Z);
+    }
+#elif defined(FOURMOMENTUM_USE_SSE2)
+    const Lanes bx = splat(bx_), by = splat(by_), bz = splat(bz_), g = splat(gamma_), gf = splat(gammaFactor_);
+    for (; i + 2 <= n; i += 2) {
+        Lanes lo0 = _mm_load_pd(&p[i].components[0]), hi0 = _mm_load_pd(&p[i].components[2]);
+        Lanes lo1 = _mm_load_pd(&p[i + 1].components[0]), hi1 = _mm_load_pd(&p[i + 1].components[2]);
+        Lanes E = _mm_unpacklo_pd(lo0, lo1), X = _mm_unpackhi_pd(lo0, lo1);
+        Lanes Y = _mm_unpacklo_pd(hi0, hi1), Z = _mm_unpackhi_pd(hi0, hi1);
+        Lanes bp = add(add(mul(bx, X), mul(by, Y)), mul(bz, Z));
+        Lanes k = add(mul(gf, bp), mul(g, E));
+        E = mul(g, add(E, bp));
+        X = add(X, mul(k, bx));
+        Y = add(Y, mul(k, by));
+        Z = add(Z, mul(k, bz));
+        _mm_store_pd(&p[i].components[0], _mm_unpacklo_pd(E, X));
+        _mm_store_pd(&p[i + 1].components[0], _mm_unpackhi_pd(E, X));
+        _mm_store_pd(&p[i].components[2], _mm_unpacklo_pd(Y, Z));
+        _mm_store_pd(&p[i + 1].components[2], _mm_unpackhi_pd(Y, Z));
+    }
+#endif
+    for (; i < n; i++) {
+        std::array<double, 4>& c = p[i].components;
+        double bp = bx_ * c[1] + by_ * c[2] + bz_ * c[3];
+        double k = gammaFactor_ * bp + gamma_ * c[0];
+        c[0] = gamma_ * (c[0] + bp);
+        c[1] += k * bx_;
+        c[2] += k * by_;
+        c[3] += k * bz_;
+    }
+}
+
+void LorentzBoost::apply(const double* E, const double* px, const double* py, const double* pz,
+                         double* outE, double* outPx, double* outPy, double* outPz, std::size_t n) const {
+    std::size_t i = 0;
+#if defined(FOURMOMENTUM_USE_AVX) || defined(FOURMOMENTUM_USE_SSE2)
+    const Lanes bx = splat(bx_), by = splat(by_), bz = splat(bz_), g = splat(gamma_), gf = splat(gammaFactor_);
+    for (; i + laneCount <= n; i += laneCount) {
+        Lanes e = loadLanes(E + i), x = loadLanes(px + i), y = loadLanes(py + i), z = loadLanes(pz + i);
+        Lanes bp = add(add(mul(bx, x), mul(by, y)), mul(bz, z));
+        Lanes k = add(mul(gf, bp), mul(g, e));
+        storeLanes(outE + i, mul(g, add(e, bp)));
+        storeLanes(outPx + i, add(x, mul(k, bx)));
+        storeLanes(outPy + i, add(y, mul(k, by)));
+        storeLanes(outPz + i, add(z, mul(k, bz)));
+    }
+#endif
+    for (; i < n; i++) {
+        double e = E[i], x = px[i], y = py[i], z = pz[i];
+        double bp = bx_ * x + by_ * y + bz_ * z;
+        double k = gammaFactor_ * bp + gamma_ * e;
+        outE[i] = gamma_ * (e + bp);
+        outPx[i] = x + k * bx_;
+        outPy[i] = y + k * by_;
+        outPz[i] = z + k * bz_;
+    }
+}
+
+Rotation3 Rotation3::aboutX(double angle) {
+    double c = std::cos(angle), s = std::sin(angle);
+    return Rotation3({1, 0, 0, 0, c, -s, 0, s, c});
+}
+
+Rotation3 Rotation3::aboutY(double angle) {
+    double c = std::cos(angle), s = std::sin(angle);
+    return Rotation3({c, 0, s, 0, 1, 0, -s, 0, c});
+}
+
+Rotation3 Rotation3::aboutZ(double angle) {
+    double c = std::cos(angle), s = std::sin(angle);
+    return Rotation3({c, -s, 0, s, c, 0, 0, 0, 1});
+}
+
+Rotation3 Rotation3::aboutAxis(double ax, double ay, double az, double angle) {
+    double norm = std::sqrt(ax * ax + ay * ay + az * az);
+    if (norm == 0.0) {
+        throw std::invalid_argument("Rotation axis must be non-zero.");
+    }
+    ax /= norm;
+    ay /= norm;
+    az /= norm;
+    double c = std::cos(angle), s = std::sin(angle), t = 1.0 - c;
+    return Rotation3({t * ax * ax + c, t * ax * ay - s * az, t * ax * az + s * ay,
+                      t * ax * ay + s * az, t * ay * ay + c, t * ay * az - s * ax,
+                      t * ax * az - s * ay, t * ay * az + s * ax, t * az * az + c});
+}
+
+Rotation3 Rotation3::operator*(const Rotation3& other) const {
+    std::array<double, 9> m{};
+    for (int r = 0; r < 3; r++) {
+        for (int c = 0; c < 3; c++) {
+            m[3 * r + c] = m_[3 * r] * other.m_[c] + m_[3 * r + 1] * other.m_[3 + c] + m_[3 * r + 2] * other.m_[6 + c];
+        }
+    }
+    return Rotation3(m);
+}
+
+Rotation3 Rotation3::inverse() const {
+    return Rotation3({m_[0], m_[3], m_[6], m_[1], m_[4], m_[7], m_[2], m_[5], m_[8]});
+}
+
+FourMomentum Rotation3::apply(const FourMomentum& p) const {
+    FourMomentum result = p;
+    apply(&result, 1);
+    return result;
+}
+
+void Rotation3::apply(FourMomentum* p, std::size_t n) const {
+    std::size_t i = 0;
+#if defined(FOURMOMENTUM_USE_AVX)
+    for (; i + 4 <= n; i += 4) {
+        Lanes E = _mm256_load_pd(p[i].components.data()), X = _mm256_load_pd(p[i + 1].components.data());
+        Lanes Y = _mm256_load_pd(p[i + 2].components.data()), Z = _mm256_load_pd(p[i + 3].components.data());
+        transpose(E, X, Y, Z);
+        Lanes x = add(add(mul(splat(m_[0]), X), mul(splat(m_[1]), Y)), mul(splat(m_[2]), Z));
+        Lanes y = add(add(mul(splat(m_[3]), X), mul(splat(m_[4]), Y)), mul(splat(m_[5]), Z));
+        Lanes z = add(add(mul(splat(m_[6]), X), mul(splat(m_[7]), Y)), mul(splat(m_[8]), Z));
+        transpose(E, x, y, z);
+        _mm256_store_pd(p[i].components.data(), E);
+        _mm256_store_pd(p[i + 1].components.data(), x);
+        _mm256_store_pd(p[i + 2].components.data(), y);
+        _mm256_store_pd(p[i + 3].components.data(), z);
+    }
+#endif
+    for (; i < n; i++) {
+        std::array<double, 4>& c = p[i].components;
+        double x = c[1], y = c[2], z = c[3];
+        c[1] = m_[0] * x + m_[1] * y + m_[2] * z;
+        c[2] = m_[3] * x + m_[4] * y + m_[5] * z;
+        c[3] = m_[6] * x + m_[7] * y + m_[8] * z;
+    }
+}
+
+void Rotation3::apply(const double* px, const double* py, const double* pz,
+                      double* outPx, double* outPy, double* outPz, std::size_t n) const {
+    std::size_t i = 0;
+#if defined(FOURMOMENTUM_USE_AVX) || defined(FOURMOMENTUM_USE_SSE2)
+    const Lanes m0 = splat(m_[0]), m1 = splat(m_[1]), m2 = splat(m_[2]);
+    const Lanes m3 = splat(m_[3]), m4 = splat(m_[4]), m5 = splat(m_[5]);
+    const Lanes m6 = splat(m_[6]), m7 = splat(m_[7]), m8 = splat(m_[8]);
+    for (; i + laneCount <= n; i += laneCount) {
+        Lanes x = loadLanes(px + i), y = loadLanes(py + i), z = loadLanes(pz + i);
+        storeLanes(outPx + i, add(add(mul(m0, x), mul(m1, y)), mul(m2, z)));
+        storeLanes(outPy + i, add(add(mul(m3, x), mul(m4, y)), mul(m5, z)));
+        storeLanes(outPz + i, add(add(mul(m6, x), mul(m7, y)), mul(m8, z)));
+    }
+#endif
+    for (; i < n; i++) {
+        double x = px[i], y = py[i], z = pz[i];
+        outPx[i] = m_[0] * x + m_[1] * y + m_[2] * z;
+        outPy[i] = m_[3] * x + m_[4] * y + m_[5] * z;
+        outPz[i] = m_[6] * x + m_[7] * y + m_[8] * z;
+    }
+}
@@ -0,0 +1,63 @@
+#ifndef LORENTZ_TRANSFORM_H
+#define LORENTZ_TRANSFORM_H
+
+#include "FourMomentum.h"
+#include <array>
+#include <cstddef>
+
+// Pure Lorentz boost by velocity beta (units of c), precomputed so one boost can be applied
+// to many four-vectors. Follows the active convention: a particle at rest boosted by beta
+// moves with velocity beta afterwards.
+class LorentzBoost {
+private:
+    double bx_, by_, bz_;
+    double gamma_;
+    double gammaFactor_;  // (gamma - 1) / beta^2, well defined at beta = 0
+
+public:
+    LorentzBoost(double bx, double by, double bz);
+
+    // Boost into the rest frame of p (p must be timelike with E > 0)
+    static LorentzBoost toRestFrameOf(const FourMomentum& p);
+
+    double gamma() const { return gamma_; }
+    std::array<double, 3> beta() const { return {bx_, by_, bz_}; }
+    LorentzBoost inverse() const { return LorentzBoost(-bx_, -by_, -bz_); }
+
+    FourMomentum apply(const FourMomentum& p) const;
+
+    // In place over an array of four-vectors
+    void apply(FourMomentum* p, std::size_t n) const;
+
+    // Over E/px/py/pz columns, e.g. ParticleColumns; output may alias input
+    void apply(const double* E, const double* px, const double* py, const double* pz,
+               double* outE, double* outPx, double* outPy, double* outPz, std::size_t n) const;
+};
+
+// Spatial rotation acting on (px, py, pz); energy is unchanged
+class Rotation3 {
+private:
+    std::array<double, 9> m_;  // Row-major 3x3 matrix
+
+    explicit Rotation3(const std::array<double, 9>& m) : m_(m) {}
+
+public:
+    Rotation3() : m_{1, 0, 0, 0, 1, 0, 0, 0, 1} {}
+
+    static Rotation3 aboutX(double angle);
+    static Rotation3 aboutY(double angle);
+    static Rotation3 aboutZ(double angle);
+    // Rotation by angle (right-handed) about the axis (ax, ay, az), which need not be normalized
+    static Rotation3 aboutAxis(double ax, double ay, double az, double angle);
+
+    // Applies other first, then this
+    Rotation3 operator*(const Rotation3& other) const;
+    Rotation3 inverse() const;
+
+    FourMomentum apply(const FourMomentum& p) const;
+    void apply(FourMomentum* p, std::size_t n) const;
+    void apply(const double* px, const double* py, const double* pz,
+               double* outPx, double* outPy, double* outPz, std::size_t n) const;
+};
+
+#endif // LORENTZ_TRANSFORM_H
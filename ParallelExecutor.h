@@ -0,0 +1,110 @@
+#ifndef PARALLEL_EXECUTOR_H
+#define PARALLEL_EXECUTOR_H
+
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <algorithm>
+
+// Runs work over fixed-size blocks of an index range on a configurable number of threads.
+// Blocks have the same boundaries whatever the thread count, so any per-block result
+// combined in block order is deterministic.
+class ParallelExecutor {
+private:
+    unsigned threads_;
+
+public:
+    static constexpr std::size_t defaultBlockSize = 16384;
+
+    explicit ParallelExecutor(unsigned threads = 0) { setThreadCount(threads); }
+
+    // 0 selects the hardware concurrency
+    void setThreadCount(unsigned threads) {
+        if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+        threads_ = threads;
+    }
+
+    unsigned getThreadCount() const { return threads_; }
+
+    static std::size_t blockCount(std::size_t n, std::size_t blockSize = defaultBlockSize) {
+        return (n + blockSize - 1) / blockSize;
+    }
+
+    // Calls fn(blockIndex) for every block in [0, blocks); blocks are handed out dynamically.
+    // The first exception thrown by fn is rethrown on the calling thread.
+    template<typename Fn>
+    void forEachBlock(std::size_t blocks, Fn&& fn) const {
+        unsigned workers = static_cast<unsigned>(std::min<std::size_t>(threads_, blocks));
+        if (workers <= 1) {
+            for (std::size_t b = 0; b < blocks; b++) fn(b);
+            return;
+        }
+        std::atomic<std::size_t> next{0};
+        std::exception_ptr error;
+        std::mutex errorMutex;
+        auto work = [&]() {
+            try {
+                for (std::size_t b = next.fetch_add(1); b < blocks; b = next.fetch_add(1)) fn(b);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(errorMutex);
+                if (!error) error = std::current_exception();
+                next.store(blocks);
+            }
+        };
+        std::vector<std::thread> pool;
+        pool.reserve(workers - 1);
+        for (unsigned t = 1; t < workers; t++) pool.emplace_back(work);
+        work();
+        for (auto& thread : pool) thread.join();
+        if (error) std::rethrow_exception(error);
+    }
+
+    // Calls fn(begin, end, blockIndex) for each block of [0, n)
+    template<typename Fn>
+    void forEachRange(std::size_t n, Fn&& fn, std::size_t blockSize = defaultBlockSize) const {
+        forEachBlock(blockCount(n, blockSize), [&](std::size_t b) {
+            std::size_t begin = b * blockSize;
+            fn(begin, std::min(n, begin + blockSize), b);
+        });
+    }
+
+    // Pairwise reduction of values in a fixed tree shape: ((0+1)+(2+3))+... regardless of threads
+    template<typename T, typename Combine>
+    static T treeReduce(std::vector<T> values, T identity, Combine combine) {
+        if (values.empty()) return identity;
+        for (std::size_t stride = 1; stride < values.size(); stride *= 2) {
+            for (std::size_t i = 0; i + stride < values.size(); i += 2 * stride) {
+                values[i] = combine(values[i], values[i + stride]);
+            }
+        }
+        return values[0];
+    }
+
+    // Stable parallel merge sort: blocks are sorted concurrently, then merged pairwise
+    // in rounds, each round's merges running in parallel.
+    template<typename T, typename Compare>
+    void mergeSort(std::vector<T>& data, Compare comp, std::size_t blockSize = defaultBlockSize) const {
+        const std::size_t n = data.size();
+        forEachRange(n, [&](std::size_t begin, std::size_t end, std::size_t) {
+            std::stable_sort(data.begin() + begin, data.begin() + end, comp);
+        }, blockSize);
+        std::vector<T> buffer(n);
+        for (std::size_t width = blockSize; width < n; width *= 2) {
+            std::size_t pairs = (n + 2 * width - 1) / (2 * width);
+            forEachBlock(pairs, [&](std::size_t pair) {
+                std::size_t begin = pair * 2 * width;
+                std::size_t middle = std::min(n, begin + width);
+                std::size_t end = std::min(n, begin + 2 * width);
+                std::merge(std::make_move_iterator(data.begin() + begin), std::make_move_iterator(data.begin() + middle),
+                           std::make_move_iterator(data.begin() + middle), std::make_move_iterator(data.begin() + end),
+                           buffer.begin() + begin, comp);
+            });
+            data.swap(buffer);
+        }
+    }
+};
+
+#endif // PARALLEL_EXECUTOR_H
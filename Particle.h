@@ -3,10 +3,12 @@
 
 #include <iostream>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <memory>
 #include <iomanip> // For std::setprecision and std::fixed
 #include "FourMomentum.h"
+#include "ParticleId.h"
 
 class Particle {
 public:
@@ -17,17 +19,26 @@ public:
     virtual double charge() const = 0;
     virtual double spin() const = 0;
     virtual void print(bool detailed) const = 0;
-    virtual std::string getType() const = 0;
+    virtual std::string_view getType() const = 0;  // Names point into static storage
     virtual FourMomentum getFourMomentum() const = 0;
 
+    // Flavour id; classes outside this library that keep the default are counted by getType()
+    virtual ParticleId getId() const { return ParticleId::Unknown; }
+
     // Optional virtual functions for quantum numbers and stability
     virtual int getBaryonNumber() const { return 0; }
     virtual int getLeptonNumber() const { return 0; }
     virtual bool isStable() const { return true; }
 
-    // Enhanced decay mechanism to allow more flexible handling of decays
+    // Direct decay products, without copying; empty by default
+    virtual const std::vector<std::shared_ptr<Particle>>& getDecayProducts() const {
+        static const std::vector<std::shared_ptr<Particle>> none;
+        return none;
+    }
+
+    // Copy of getDecayProducts(), kept for existing callers
     virtual std::vector<std::shared_ptr<Particle>> decayProducts() const {
-        return {}; // By default, an empty vector (no decay products)
+        return getDecayProducts();
     }
 
     // Virtual functions for properties specific to certain types of particles
@@ -0,0 +1,151 @@
+#ifndef PARTICLE_ARENA_H
+#define PARTICLE_ARENA_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+template<typename T>
+class ArenaRef;
+
+// Event-scoped bump allocator for particles and their decay trees.
+// Objects are placed back to back in large blocks, so creating a particle costs no heap
+// allocation. The arena owns every object it creates: reset() destroys them all and
+// rewinds the blocks for the next event. create() hands out non-owning ArenaRef handles,
+// which refuse to be used after a reset.
+class ParticleArena {
+private:
+    static constexpr std::size_t blockAlignment = 64;
+
+    struct Block {
+        std::byte* memory;
+        std::size_t size;
+    };
+
+    struct Destructor {
+        void (*destroy)(void*);
+        void* object;
+    };
+
+    std::size_t blockSize_;
+    std::vector<Block> blocks_;
+    std::size_t currentBlock_ = 0;  // Block currently being filled
+    std::size_t offset_ = 0;        // Bytes used in the current block
+    std::vector<Destructor> destructors_;
+    std::uint64_t generation_ = 0;  // Incremented by reset()
+
+    void* allocate(std::size_t size, std::size_t alignment) {
+        while (currentBlock_ < blocks_.size()) {
+            Block& block = blocks_[currentBlock_];
+            std::size_t aligned = (offset_ + alignment - 1) & ~(alignment - 1);
+            if (aligned + size <= block.size) {
+                offset_ = aligned + size;
+                return block.memory + aligned;
+            }
+            currentBlock_++;
+            offset_ = 0;
+        }
+        std::size_t capacity = std::max(blockSize_, size);
+        blocks_.push_back({static_cast<std::byte*>(::operator new(capacity, std::align_val_t(blockAlignment))), capacity});
+        currentBlock_ = blocks_.size() - 1;
+        offset_ = size;
+        return blocks_.back().memory;
+    }
+
+    void destroyAll() {
+        for (auto it = destructors_.rbegin(); it != destructors_.rend(); ++it) {
+            it->destroy(it->object);
+        }
+        destructors_.clear();
+    }
+
+public:
+    explicit ParticleArena(std::size_t blockSize = 1 << 20) : blockSize_(blockSize) {}
+
+    ParticleArena(const ParticleArena&) = delete;
+    ParticleArena& operator=(const ParticleArena&) = delete;
+
+    ~ParticleArena() {
+        destroyAll();
+        for (const Block& block : blocks_) {
+            ::operator delete(block.memory, std::align_val_t(blockAlignment));
+        }
+    }
+
+    template<typename T, typename... Args>
+    ArenaRef<T> create(Args&&... args) {
+        static_assert(alignof(T) <= blockAlignment, "Over-aligned type for ParticleArena");
+        void* memory = allocate(sizeof(T), alignof(T));
+        T* object = new (memory) T(std::forward<Args>(args)...);
+        destructors_.push_back({[](void* p) { static_cast<T*>(p)->~T(); }, object});
+        return ArenaRef<T>(object, this, generation_);
+    }
+
+    // Destroys all objects and rewinds to the first block; the blocks are kept for reuse.
+    // Every ArenaRef handed out so far becomes invalid.
+    void reset() {
+        destroyAll();
+        currentBlock_ = 0;
+        offset_ = 0;
+        generation_++;
+    }
+
+    std::uint64_t generation() const { return generation_; }
+
+    std::size_t objectCount() const { return destructors_.size(); }
+    std::size_t blockCount() const { return blocks_.size(); }
+
+    std::size_t bytesReserved() const {
+        std::size_t total = 0;
+        for (const Block& block : blocks_) total += block.size;
+        return total;
+    }
+};
+
+// Non-owning handle to an object in a ParticleArena; copying it touches no reference count.
+// Dereferencing a handle after its arena was reset throws std::logic_error. A handle must
+// not outlive the arena itself, as with any reference.
+template<typename T>
+class ArenaRef {
+private:
+    template<typename U>
+    friend class ArenaRef;
+
+    T* object_ = nullptr;
+    const ParticleArena* arena_ = nullptr;
+    std::uint64_t generation_ = 0;
+
+public:
+    ArenaRef() = default;
+    ArenaRef(T* object, const ParticleArena* arena, std::uint64_t generation)
+        : object_(object), arena_(arena), generation_(generation) {}
+
+    template<typename U, typename = std::enable_if_t<std::is_convertible<U*, T*>::value>>
+    ArenaRef(const ArenaRef<U>& other) : object_(other.object_), arena_(other.arena_), generation_(other.generation_) {}
+
+    // False for an empty handle or once the arena has been reset
+    bool valid() const { return object_ && arena_->generation() == generation_; }
+    explicit operator bool() const { return object_ != nullptr; }
+
+    T* get() const {
+        if (!valid()) {
+            throw std::logic_error(object_ ? "ArenaRef used after its arena was reset." : "Empty ArenaRef dereferenced.");
+        }
+        return object_;
+    }
+
+    T& operator*() const { return *get(); }
+    T* operator->() const { return get(); }
+
+    // The object as a std::shared_ptr without a control block, e.g. to add it to a catalogue
+    // or as a decay product. Like the handle it owns nothing, but it is not checked on use.
+    std::shared_ptr<T> share() const { return std::shared_ptr<T>(std::shared_ptr<T>(), get()); }
+};
+
+#endif // PARTICLE_ARENA_H
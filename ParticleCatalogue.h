@@ -2,49 +2,481 @@
 #define PARTICLE_CATALOGUE_H
 
 #include "Particle.h"
+#include "CalorimeterStore.h"
+#include "CatalogueAggregates.h"
+#include "CatalogueExporter.h"
+#include "CatalogueSketches.h"
+#include "DecayTable.h"
+#include "Instrumentation.h"
+#include "Lepton.h"
+#include "ParticleColumns.h"
+#include "ParallelExecutor.h"
+#include "ParticleArena.h"
+#include "ParticleIndex.h"
+#include "ResonanceSearch.h"
+#include "ValidationReport.h"
 #include <vector>
+#include <numeric>
 #include <memory>
 #include <algorithm>
 #include <typeinfo>
 #include <unordered_map>
 #include <iostream>
 #include <functional>
+#include <array>
+#include <limits>
+#include <cmath>
+#include <utility>
+#include <optional>
+#include <stdexcept>
+
+class ParticleQuery;
 
 class ParticleCatalogue {
 private:
+    friend class ParticleQuery;
+
+    // Owns the arena, and the calorimeter store of the electrons built in it, through pointers,
+    // so moving the catalogue leaves ArenaRefs and the electrons' store pointers valid. Rows
+    // built in the arena are only aliased by the catalogue's shared_ptrs, so a copy could not
+    // keep them alive: copying throws std::logic_error while the arena holds any.
+    struct ArenaHolder {
+        std::unique_ptr<ParticleArena> arena;
+        std::unique_ptr<CalorimeterStore> calorimeters;
+
+        ArenaHolder() = default;
+        ArenaHolder(const ArenaHolder& other) { other.checkCopyable(); }
+        ArenaHolder(ArenaHolder&&) noexcept = default;
+        ArenaHolder& operator=(const ArenaHolder& other) {
+            other.checkCopyable();
+            if (this != &other) reset();
+            return *this;
+        }
+        ArenaHolder& operator=(ArenaHolder&&) noexcept = default;
+
+        ParticleArena& get() {
+            if (!arena) arena = std::make_unique<ParticleArena>();
+            return *arena;
+        }
+
+        CalorimeterStore& layers() {
+            if (!calorimeters) calorimeters = std::make_unique<CalorimeterStore>();
+            return *calorimeters;
+        }
+
+        void checkCopyable() const {
+            if (arena && arena->objectCount() > 0) {
+                throw std::logic_error("Cannot copy a ParticleCatalogue holding particles built with createParticle; move it or clear() it first.");
+            }
+        }
+
+        void reset() {
+            if (arena) arena->reset();
+            if (calorimeters) calorimeters->clear();
+        }
+    };
+
+    // Storage for particles built with createParticle and the calorimeter layers of electrons
+    // built with createElectron, released by clear(). Declared first, so a refused copy
+    // throws before any other member is copied.
+    ArenaHolder arena;
     std::vector<std::shared_ptr<Particle>> particles;
+    ParticleColumns columns;  // Columnar mirror of particles, row i describes particles[i]
+    ParallelExecutor executor;  // Thread pool settings for the *Parallel queries
+    ParticleIndex index;  // Secondary indexes by type, class, charge, energy and pT
+    CatalogueAggregates aggregates;  // Running totals, updated by addParticle
+    std::optional<CatalogueSketches> sketches;  // Updated by addParticle once enableSketches() is called
+    DecayTable decayTable;  // Built by buildDecayTable() after the rows change
+    bool decayTableValid = false;
+    ValidationMode validationMode = defaultValidationMode;
+    ValidationReport validationReport;  // Failed checks of particles built under validationScope()
+
+    std::array<double, 4> sumRange(size_t begin, size_t end) const {
+        const double* E = columns.energy().data();
+        const double* px = columns.px().data();
+        const double* py = columns.py().data();
+        const double* pz = columns.pz().data();
+        double totalE = 0.0, totalPx = 0.0, totalPy = 0.0, totalPz = 0.0;
+        for (size_t i = begin; i < end; i++) {
+            totalE += E[i];
+            totalPx += px[i];
+            totalPy += py[i];
+            totalPz += pz[i];
+        }
+        return {totalE, totalPx, totalPy, totalPz};
+    }
+
+    void countRange(size_t begin, size_t end, std::vector<int>& countsById) const {
+        const std::uint16_t* typeIds = columns.typeId().data();
+        for (size_t i = begin; i < end; i++) {
+            countsById[typeIds[i]]++;
+        }
+    }
+
+    std::unordered_map<std::string, int> namedCounts(const std::vector<int>& countsById) const {
+        std::unordered_map<std::string, int> counts;
+        for (size_t id = 0; id < countsById.size(); id++) {
+            if (countsById[id] > 0) counts[std::string(columns.typeName(static_cast<std::uint16_t>(id)))] = countsById[id];
+        }
+        return counts;
+    }
+
+    // Reorders objects and columns so that new row i is old row order[i]
+    void applyOrder(const std::vector<size_t>& order) {
+        std::vector<std::shared_ptr<Particle>> sorted;
+        sorted.reserve(particles.size());
+        for (size_t index : order) {
+            sorted.push_back(std::move(particles[index]));
+        }
+        particles.swap(sorted);
+        columns.permute(order);
+        index.rebuild(columns);
+        decayTableValid = false;
+    }
+
+    std::vector<std::shared_ptr<Particle>> particlesAt(const std::vector<size_t>& rows) const {
+        std::vector<std::shared_ptr<Particle>> result;
+        result.reserve(rows.size());
+        for (size_t row : rows) {
+            result.push_back(particles[row]);
+        }
+        return result;
+    }
+
+    // Particles of the bucket with lo <= key <= hi in ascending key order, from the key index
+    // when range indexes are enabled and by scanning the bucket otherwise
+    template<typename Key>
+    std::vector<std::shared_ptr<Particle>> particlesInRange(const ParticleIndex::Bucket& bucket, const SortedKeyIndex& keys,
+                                                            Key&& key, double lo, double hi) const {
+        std::vector<std::shared_ptr<Particle>> result;
+        if (index.hasRangeIndexes()) {
+            keys.forEachInRange(lo, hi, [&](size_t row) { result.push_back(particles[row]); });
+            return result;
+        }
+        std::vector<std::pair<double, size_t>> matches;
+        for (size_t row : bucket.rows) {
+            double k = key(row);
+            if (k >= lo && k <= hi) matches.push_back({k, row});
+        }
+        std::stable_sort(matches.begin(), matches.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+        result.reserve(matches.size());
+        for (const auto& match : matches) result.push_back(particles[match.second]);
+        return result;
+    }
+
+    std::vector<std::shared_ptr<Particle>> particlesInEnergyRange(const ParticleIndex::Bucket& bucket, double lo, double hi) const {
+        return particlesInRange(bucket, bucket.energy, [&](size_t row) { return columns.energy()[row]; }, lo, hi);
+    }
+
+    std::vector<std::shared_ptr<Particle>> particlesInPtRange(const ParticleIndex::Bucket& bucket, double lo, double hi) const {
+        return particlesInRange(bucket, bucket.transverseMomentum, [&](size_t row) { return std::hypot(columns.px()[row], columns.py()[row]); }, lo, hi);
+    }
+
+    // Rows of the named types in ascending order; every row when types is empty
+    std::vector<size_t> rowsOfTypes(const std::vector<std::string>& types) const {
+        if (types.empty()) return index.all().rows;
+        std::vector<size_t> rows;
+        for (const std::string& type : types) {
+            const auto& bucket = typeBucket(type).rows;
+            rows.insert(rows.end(), bucket.begin(), bucket.end());
+        }
+        std::sort(rows.begin(), rows.end());
+        rows.erase(std::unique(rows.begin(), rows.end()), rows.end());
+        return rows;
+    }
+
+    template<typename ParticleType>
+    const ParticleIndex::Bucket& classBucket() const {
+        int classId = columns.findClass(typeid(ParticleType));
+        return classId == ParticleColumns::npos ? index.none() : index.dynamicClass(static_cast<std::uint16_t>(classId));
+    }
+
+    const ParticleIndex::Bucket& typeBucket(const std::string& type) const {
+        int typeId = columns.findType(type);
+        return typeId == ParticleColumns::npos ? index.none() : index.type(static_cast<std::uint16_t>(typeId));
+    }
 
 public:
     void addParticle(const std::shared_ptr<Particle>& particle) {
         if (particle) {
+            PARTICLE_COUNT(ParticlesAdded);
             particles.push_back(particle);
+            columns.append(*particle);
+            index.add(columns, columns.size() - 1);
+            aggregates.add(columns, columns.size() - 1);
+            if (sketches) sketches->add(columns, columns.size() - 1, *particle);
+            decayTableValid = false;
         } else {
             std::cerr << "Attempted to add a null particle to the catalogue." << std::endl;
         }
     }
 
+    // Builds a particle in the catalogue's arena, under the catalogue's validation policy, and
+    // adds it. The catalogue owns the particle until clear(); the handle is non-owning.
+    template<typename ParticleType, typename... Args>
+    ArenaRef<ParticleType> createParticle(Args&&... args) {
+        ValidationScope scope = validationScope();
+        ArenaRef<ParticleType> particle = arena.get().create<ParticleType>(std::forward<Args>(args)...);
+        addParticle(particle.share());
+        return particle;
+    }
+
+    // Builds an electron whose calorimeter layers are kept in the catalogue's shared store
+    // instead of a vector of its own. Its energy check is deferred to reconcileCalorimeters().
+    ArenaRef<Electron> createElectron(double charge, double spin, const FourMomentum& fourMomentum,
+                                      const double* layers, size_t layerCount) {
+        CalorimeterStore& store = arena.layers();
+        return createParticle<Electron>(charge, spin, fourMomentum, store, store.append(layers, layerCount));
+    }
+
+    ArenaRef<Electron> createElectron(double charge, double spin, const FourMomentum& fourMomentum,
+                                      const std::vector<double>& layers) {
+        return createElectron(charge, spin, fourMomentum, layers.data(), layers.size());
+    }
+
+    // Runs the Electron calorimeter check for the electrons built with createElectron since
+    // the last call in one SIMD pass, corrects mismatched momenta as the constructor would, and
+    // returns the rows whose momentum changed. A mismatch whose invariant mass already equals
+    // the layer sum is left as is and not returned. Mismatches are recorded under the
+    // catalogue's validation policy; Strict mode logs a single summary line rather than one
+    // warning per electron.
+    std::vector<size_t> reconcileCalorimeters() {
+        PARTICLE_TIME_SCOPE(ReconcileCalorimeters);
+        // Blocks of electrons are gathered into small SoA buffers that stay in cache
+        constexpr size_t blockSize = 1024;
+        std::vector<size_t> rows(blockSize);
+        std::vector<CalorimeterStore::Range> ranges(blockSize);
+        std::vector<double> E(blockSize), px(blockSize), py(blockSize), pz(blockSize), sums(blockSize);
+        std::vector<std::uint8_t> mismatch(blockSize), adjust(blockSize);
+        std::vector<size_t> adjusted;
+        size_t mismatches = 0;
+        std::vector<std::uint8_t> changed;
+        ValidationScope scope = validationScope();
+        bool strict = false;
+
+        if (!arena.calorimeters) return adjusted;
+        const CalorimeterStore& calorimeters = *arena.calorimeters;
+        const std::vector<size_t>& electronRows = classBucket<Electron>().rows;
+        size_t next = 0;
+        while (next < electronRows.size()) {
+            size_t n = 0;
+            for (; next < electronRows.size() && n < blockSize; next++) {
+                size_t row = electronRows[next];
+                Electron& electron = static_cast<Electron&>(*particles[row]);
+                if (electron.calorimeterChecked_ || electron.store_ != &calorimeters) continue;
+                electron.calorimeterChecked_ = true;
+                rows[n] = row;
+                ranges[n] = electron.layers_;
+                E[n] = columns.energy()[row];
+                px[n] = columns.px()[row];
+                py[n] = columns.py()[row];
+                pz[n] = columns.pz()[row];
+                n++;
+            }
+            if (calorimeters.reconcile(ranges.data(), E.data(), px.data(), py.data(), pz.data(), sums.data(), mismatch.data(), adjust.data(), n) == 0) continue;
+
+            for (size_t i = 0; i < n; i++) {
+                if (!mismatch[i]) continue;
+                Electron& electron = static_cast<Electron&>(*particles[rows[i]]);
+                strict = Validation::fail(ValidationIssue::CalorimeterMismatch, electron.getType(), electron.fourMomentum_.getComponent(0), sums[i]) || strict;
+                mismatches++;
+                if (!adjust[i]) continue;
+                if (changed.empty()) changed.assign(columns.size(), 0);
+                FourMomentum corrected(E[i], px[i], py[i], pz[i]);
+                aggregates.replaceMomentum(electron.fourMomentum_, corrected);
+                if (sketches) sketches->replaceMomentum(electron.fourMomentum_, corrected);
+                electron.fourMomentum_ = corrected;
+                columns.setFourMomentum(rows[i], corrected);
+                changed[rows[i]] = 1;
+                adjusted.push_back(rows[i]);
+            }
+        }
+        PARTICLE_COUNT_N(CalorimeterMismatch, mismatches);
+        if (strict) {
+            std::cerr << "Warning: Total calorimeter energy does not match the energy of " << mismatches
+                      << " electron(s); " << adjusted.size() << " momenta were adjusted." << std::endl;
+        }
+        if (adjusted.empty()) return adjusted;
+        index.updateMomenta(columns, changed);
+        decayTableValid = false;
+        return adjusted;
+    }
+
+    // Validation of particles built by createParticle, or elsewhere under validationScope()
+    void setValidationMode(ValidationMode mode) {
+        validationMode = mode;
+    }
+
+    ValidationMode getValidationMode() const {
+        return validationMode;
+    }
+
+    // Applies the catalogue's policy on this thread until the scope ends, e.g. while a
+    // loader constructs particles with make_shared before adding them
+    ValidationScope validationScope() {
+        return ValidationScope(validationMode, &validationReport);
+    }
+
+    const ValidationReport& getValidationReport() const {
+        return validationReport;
+    }
+
+    ValidationReport& getValidationReport() {
+        return validationReport;
+    }
+
+    // Arena for decay products that belong to the current event but are not catalogued themselves
+    ParticleArena& getArena() {
+        return arena.get();
+    }
+
+    // Ends the event: particles built in the arena are destroyed and their memory rewound
+    // in one step. ArenaRefs to them throw after this call; shared_ptrs to them, such as
+    // earlier getParticles() copies, must not be kept past it.
     void clear() {
+        PARTICLE_TIME_SCOPE(Clear);
         particles.clear();
+        columns.clear();
+        index.clear();
+        aggregates.clear();
+        if (sketches) sketches->clear();
+        decayTable = DecayTable();
+        decayTableValid = false;
+        arena.reset();
+    }
+
+    void reserve(size_t n) {
+        particles.reserve(n);
+        columns.reserve(n);
+    }
+
+    const std::vector<std::shared_ptr<Particle>>& getParticles() const {
+        return particles;
+    }
+
+    const ParticleColumns& getColumns() const {
+        return columns;
     }
 
     size_t getTotalNumberOfParticles() const {
         return particles.size();
     }
 
+    // The totals below are kept up to date by addParticle and read in O(1); sums are
+    // compensated, so they stay accurate however many particles have been added.
+    const CatalogueAggregates& getAggregates() const {
+        return aggregates;
+    }
+
     FourMomentum getTotalFourMomentum() const {
-        FourMomentum total;
-        for (const auto& p : particles) {
-            if (p) total += p->getFourMomentum();
-        }
-        return total;
+        PARTICLE_TIME_SCOPE(GetTotalFourMomentum);
+        return aggregates.totalFourMomentum();
+    }
+
+    double getTotalCharge() const {
+        return aggregates.totalCharge();
     }
 
+    long long getTotalLeptonNumber() const {
+        return aggregates.totalLeptonNumber();
+    }
+
+    long long getTotalBaryonNumber() const {
+        return aggregates.totalBaryonNumber();
+    }
+
+    // O(number of distinct types)
     std::unordered_map<std::string, int> getParticleCounts() const {
-        std::unordered_map<std::string, int> counts;
-        for (const auto& p : particles) {
-            if (p) counts[p->getType()]++;
+        PARTICLE_TIME_SCOPE(GetParticleCounts);
+        return namedCounts(aggregates.countsByType());
+    }
+
+    // Particles whose getType() equals type
+    int getParticleCount(const std::string& type) const {
+        int typeId = columns.findType(type);
+        return typeId == ParticleColumns::npos ? 0 : aggregates.count(static_cast<std::uint16_t>(typeId));
+    }
+
+    // Threads used by the *Parallel queries; 0 selects the hardware concurrency
+    void setThreadCount(unsigned threads) {
+        executor.setThreadCount(threads);
+    }
+
+    unsigned getThreadCount() const {
+        return executor.getThreadCount();
+    }
+
+    // Rescans the columns. Block sums are combined in a fixed pairwise tree, so the result
+    // is bit-identical across runs and thread counts (it may differ from the running total
+    // in the last few ulps). Built unchecked, as rounding can leave it slightly spacelike.
+    FourMomentum getTotalFourMomentumParallel() const {
+        PARTICLE_TIME_SCOPE(GetTotalFourMomentumParallel);
+        const size_t n = columns.size();
+        std::vector<std::array<double, 4>> partials(ParallelExecutor::blockCount(n));
+        executor.forEachRange(n, [&](size_t begin, size_t end, size_t block) {
+            partials[block] = sumRange(begin, end);
+        });
+        std::array<double, 4> total = ParallelExecutor::treeReduce(std::move(partials), std::array<double, 4>{0.0, 0.0, 0.0, 0.0},
+            [](const std::array<double, 4>& a, const std::array<double, 4>& b) {
+                return std::array<double, 4>{a[0] + b[0], a[1] + b[1], a[2] + b[2], a[3] + b[3]};
+            });
+        return FourMomentum::unchecked(total[0], total[1], total[2], total[3]);
+    }
+
+    std::unordered_map<std::string, int> getParticleCountsParallel() const {
+        PARTICLE_TIME_SCOPE(GetParticleCountsParallel);
+        const size_t n = columns.size();
+        std::vector<std::vector<int>> partials(ParallelExecutor::blockCount(n));
+        executor.forEachRange(n, [&](size_t begin, size_t end, size_t block) {
+            partials[block].assign(columns.typeCount(), 0);
+            countRange(begin, end, partials[block]);
+        });
+        std::vector<int> countsById(columns.typeCount(), 0);
+        for (const auto& partial : partials) {
+            for (size_t id = 0; id < partial.size(); id++) countsById[id] += partial[id];
         }
-        return counts;
+        return namedCounts(countsById);
+    }
+
+    // Approximate distributions and distinct counts in constant memory, for catalogues too
+    // large to rescan. Builds the sketches from the current rows in parallel; addParticle
+    // then keeps them up to date and clear() empties them.
+    void enableSketches(const CatalogueSketches::Config& config = CatalogueSketches::Config()) {
+        sketches = computeSketches(config);
+    }
+
+    void disableSketches() {
+        sketches.reset();
+    }
+
+    bool hasSketches() const {
+        return sketches.has_value();
+    }
+
+    const CatalogueSketches& getSketches() const {
+        if (!sketches) throw std::logic_error("Catalogue sketches are not enabled; call enableSketches() first.");
+        return *sketches;
+    }
+
+    // Sketches of the current rows, e.g. to merge with those of other shards. Blocks are
+    // sketched in parallel a wave at a time and merged in block order, so memory stays
+    // bounded and the result does not depend on the thread count.
+    CatalogueSketches computeSketches(const CatalogueSketches::Config& config = CatalogueSketches::Config()) const {
+        CatalogueSketches result(config);
+        const size_t n = columns.size();
+        const size_t blocks = ParallelExecutor::blockCount(n);
+        std::vector<CatalogueSketches> partials(std::min<size_t>(blocks, 4 * static_cast<size_t>(executor.getThreadCount())), result);
+        for (size_t first = 0; first < blocks; first += partials.size()) {
+            size_t wave = std::min(partials.size(), blocks - first);
+            executor.forEachBlock(wave, [&](size_t b) {
+                size_t begin = (first + b) * ParallelExecutor::defaultBlockSize;
+                size_t end = std::min(n, begin + ParallelExecutor::defaultBlockSize);
+                partials[b].clear();
+                for (size_t row = begin; row < end; row++) partials[b].add(columns, row, *particles[row]);
+            });
+            for (size_t b = 0; b < wave; b++) result.merge(partials[b]);
+        }
+        return result;
     }
 
     void printParticleCounts() const {
@@ -61,34 +493,184 @@ public:
             std::cout << "No particles in catalogue." << std::endl;
         } else {
             printParticleCounts(); // Show summary counts first
-            for (const auto& particle : particles) {
-                if (particle) {
-                    particle->print(detailed);
+            // Runs of library particles go through the exporter; other classes keep their own print
+            CatalogueExporter::Config config;
+            config.format = ExportFormat::Text;
+            config.detailed = detailed;
+            CatalogueExporter exporter(config);
+            size_t row = 0;
+            while (row < particles.size()) {
+                size_t end = row;
+                while (end < particles.size() && (!particles[end] || CatalogueExporter::hasTextLayout(*particles[end]))) end++;
+                if (end > row) {
+                    exporter.write(*this, row, end, [](const char* data, size_t size) { std::cout.write(data, static_cast<std::streamsize>(size)); });
+                    row = end;
+                } else {
+                    particles[row++]->print(detailed);
                 }
             }
         }
     }
 
+    // Lazy filter/order/aggregate chain over the rows; defined in ParticleQuery.h
+    ParticleQuery query() const;
+
+    // Exact dynamic class match, served from the class index
     template<typename ParticleType>
     std::vector<std::shared_ptr<Particle>> getParticlesByType() const {
-        std::vector<std::shared_ptr<Particle>> filteredParticles;
-        for (const auto& particle : particles) {
-            if (particle && typeid(*particle) == typeid(ParticleType)) {
-                filteredParticles.push_back(particle);
-            }
+        return particlesAt(classBucket<ParticleType>().rows);
+    }
+
+    // Particles whose getType() equals type, e.g. "Anti-Up"
+    std::vector<std::shared_ptr<Particle>> getParticlesByTypeName(const std::string& type) const {
+        return particlesAt(typeBucket(type).rows);
+    }
+
+    // Charge is matched in units of e/3
+    std::vector<std::shared_ptr<Particle>> getParticlesByCharge(double charge) const {
+        return particlesAt(index.charge(charge).rows);
+    }
+
+    // Per-bucket energy and pT key indexes for the range queries below. They are off by
+    // default, as they take about 160 bytes per particle; without them the range queries
+    // scan the matching bucket. With them a query runs in O(log n + k) plus a scan of the
+    // inserts not yet merged, which finalizeIndexes() merges.
+    void enableRangeIndexes() {
+        index.enableRangeIndexes(columns);
+    }
+
+    void disableRangeIndexes() {
+        index.disableRangeIndexes();
+    }
+
+    bool hasRangeIndexes() const {
+        return index.hasRangeIndexes();
+    }
+
+    void finalizeIndexes() {
+        index.settle();
+    }
+
+    // The range queries below return particles in ascending key order; they do not modify
+    // the catalogue and may run concurrently
+
+    template<typename ParticleType>
+    std::vector<std::shared_ptr<Particle>> getParticlesInEnergyRange(double minEnergy, double maxEnergy) const {
+        return particlesInEnergyRange(classBucket<ParticleType>(), minEnergy, maxEnergy);
+    }
+
+    std::vector<std::shared_ptr<Particle>> getParticlesInEnergyRange(const std::string& type, double minEnergy, double maxEnergy) const {
+        return particlesInEnergyRange(typeBucket(type), minEnergy, maxEnergy);
+    }
+
+    std::vector<std::shared_ptr<Particle>> getParticlesInEnergyRange(double minEnergy, double maxEnergy) const {
+        return particlesInEnergyRange(index.all(), minEnergy, maxEnergy);
+    }
+
+    template<typename ParticleType>
+    std::vector<std::shared_ptr<Particle>> getParticlesInPtRange(double minPt, double maxPt) const {
+        return particlesInPtRange(classBucket<ParticleType>(), minPt, maxPt);
+    }
+
+    std::vector<std::shared_ptr<Particle>> getChargedParticlesAbovePt(double minPt) const {
+        return particlesInPtRange(index.charged(), minPt, std::numeric_limits<double>::infinity());
+    }
+
+    // Read-only: queries on the index do not modify it
+    const ParticleIndex& getIndex() const {
+        return index;
+    }
+
+    // Combinations of query.multiplicity particles whose invariant mass lies in the query
+    // window, e.g. Z0 -> l+l- candidates. Rows refer to getParticles() and are invalidated
+    // by sorting or clearing the catalogue.
+    std::vector<ParticleCombination> findCombinations(const CombinationQuery& query) const {
+        return CombinationSearch(columns, rowsOfTypes(query.types), query).run(ParallelExecutor(1));
+    }
+
+    // Same result and order as findCombinations
+    std::vector<ParticleCombination> findCombinationsParallel(const CombinationQuery& query) const {
+        return CombinationSearch(columns, rowsOfTypes(query.types), query).run(executor);
+    }
+
+    // Flattened decay trees of all rows, rebuilt if the rows changed since the last call.
+    // Call invalidateDecayTable() after changing the decay products of particles already in
+    // the catalogue.
+    const DecayTable& buildDecayTable() {
+        if (!decayTableValid) {
+            decayTable = DecayTable(particles);
+            decayTableValid = true;
         }
-        return filteredParticles;
+        return decayTable;
+    }
+
+    // The table of the last buildDecayTable(); const queries never build it, so they are
+    // safe to run concurrently
+    const DecayTable& getDecayTable() const {
+        if (!decayTableValid) throw std::logic_error("Decay table is out of date; call buildDecayTable() first.");
+        return decayTable;
+    }
+
+    void invalidateDecayTable() {
+        decayTableValid = false;
+    }
+
+    // Catalogued particles of type ancestor with at least minCount descendants of type
+    // descendant, e.g. (Higgs, Muon, 4). Requires buildDecayTable().
+    std::vector<std::shared_ptr<Particle>> findParticlesWithDescendants(ParticleId ancestor, ParticleId descendant, size_t minCount) const {
+        const DecayTable& table = getDecayTable();
+        std::vector<std::shared_ptr<Particle>> result;
+        for (DecayTable::Node node : table.findWithDescendants(ancestor, descendant, minCount)) {
+            if (table.row(node) != DecayTable::noRow) result.push_back(particles[table.row(node)]);
+        }
+        return result;
+    }
+
+    std::vector<std::shared_ptr<Particle>> getCombinationParticles(const ParticleCombination& combination) const {
+        return particlesAt(std::vector<size_t>(combination.rows.begin(), combination.rows.begin() + combination.size));
     }
 
     void sortParticles(const std::function<bool(const std::shared_ptr<Particle>&, const std::shared_ptr<Particle>&)>& comp) {
-        std::sort(particles.begin(), particles.end(), comp);
+        PARTICLE_TIME_SCOPE(SortParticles);
+        // Sort a row permutation so the objects and the columns can be reordered together
+        std::vector<size_t> order(particles.size());
+        std::iota(order.begin(), order.end(), size_t{0});
+        std::sort(order.begin(), order.end(), [&](size_t a, size_t b) { return comp(particles[a], particles[b]); });
+        applyOrder(order);
     }
 
     std::vector<std::shared_ptr<Particle>> filterParticles(const std::function<bool(const std::shared_ptr<Particle>&)>& pred) const {
+        PARTICLE_TIME_SCOPE(FilterParticles);
         std::vector<std::shared_ptr<Particle>> result;
         std::copy_if(particles.begin(), particles.end(), std::back_inserter(result), pred);
         return result;
     }
+
+    // Stable parallel merge sort; comp is called concurrently and must be thread-safe
+    void sortParticlesParallel(const std::function<bool(const std::shared_ptr<Particle>&, const std::shared_ptr<Particle>&)>& comp) {
+        PARTICLE_TIME_SCOPE(SortParticlesParallel);
+        std::vector<size_t> order(particles.size());
+        std::iota(order.begin(), order.end(), size_t{0});
+        executor.mergeSort(order, [&](size_t a, size_t b) { return comp(particles[a], particles[b]); });
+        applyOrder(order);
+    }
+
+    // Same result and order as filterParticles; pred is called concurrently and must be thread-safe
+    std::vector<std::shared_ptr<Particle>> filterParticlesParallel(const std::function<bool(const std::shared_ptr<Particle>&)>& pred) const {
+        PARTICLE_TIME_SCOPE(FilterParticlesParallel);
+        std::vector<std::vector<std::shared_ptr<Particle>>> partials(ParallelExecutor::blockCount(particles.size()));
+        executor.forEachRange(particles.size(), [&](size_t begin, size_t end, size_t block) {
+            std::copy_if(particles.begin() + begin, particles.begin() + end, std::back_inserter(partials[block]), pred);
+        });
+        size_t total = 0;
+        for (const auto& partial : partials) total += partial.size();
+        std::vector<std::shared_ptr<Particle>> result;
+        result.reserve(total);
+        for (auto& partial : partials) {
+            std::move(partial.begin(), partial.end(), std::back_inserter(result));
+        }
+        return result;
+    }
 };
 
 #endif // PARTICLE_CATALOGUE_H
@@ -0,0 +1,147 @@
+#ifndef PARTICLE_COLUMNS_H
+#define PARTICLE_COLUMNS_H
+
+#include "Particle.h"
+#include <vector>
+#include <string>
+#include <string_view>
+#include <cstdint>
+#include <cstddef>
+#include <typeindex>
+#include <unordered_map>
+
+// Structure-of-arrays mirror of a particle list. Row i holds the properties of the i-th
+// particle in contiguous columns so aggregate queries can run without virtual calls.
+class ParticleColumns {
+private:
+    std::vector<double> energy_, px_, py_, pz_;
+    std::vector<double> charge_, spin_;
+    std::vector<int> leptonNumber_, baryonNumber_;
+    std::vector<std::uint16_t> typeId_;   // ParticleId, or an interned getType() name for Unknown ids
+    std::vector<std::uint16_t> classId_;  // Interned dynamic class
+
+    // Names of particle classes without a ParticleId; their type ids start after ParticleId::Unknown
+    std::vector<std::string> typeNames_;
+    std::unordered_map<std::string, std::uint16_t> typeIds_;
+    static constexpr std::uint16_t firstInternedType = static_cast<std::uint16_t>(ParticleId::Unknown) + 1;
+    std::vector<std::type_index> classes_;
+
+    template<typename T>
+    static void permuteColumn(std::vector<T>& column, const std::vector<std::size_t>& order) {
+        std::vector<T> permuted;
+        permuted.reserve(column.size());
+        for (std::size_t index : order) {
+            permuted.push_back(column[index]);
+        }
+        column.swap(permuted);
+    }
+
+public:
+    static constexpr int npos = -1;
+
+    void append(const Particle& particle) {
+        FourMomentum p = particle.getFourMomentum();
+        energy_.push_back(p.data()[0]);
+        px_.push_back(p.data()[1]);
+        py_.push_back(p.data()[2]);
+        pz_.push_back(p.data()[3]);
+        charge_.push_back(particle.charge());
+        spin_.push_back(particle.spin());
+        leptonNumber_.push_back(particle.getLeptonNumber());
+        baryonNumber_.push_back(particle.getBaryonNumber());
+        ParticleId id = particle.getId();
+        typeId_.push_back(id != ParticleId::Unknown ? static_cast<std::uint16_t>(id) : internType(particle.getType()));
+        classId_.push_back(internClass(typeid(particle)));
+    }
+
+    // Overwrites the momentum of a row, e.g. after a batch correction of the particle
+    void setFourMomentum(std::size_t row, const FourMomentum& p) {
+        energy_[row] = p.data()[0];
+        px_[row] = p.data()[1];
+        py_[row] = p.data()[2];
+        pz_[row] = p.data()[3];
+    }
+
+    void reserve(std::size_t n) {
+        energy_.reserve(n); px_.reserve(n); py_.reserve(n); pz_.reserve(n);
+        charge_.reserve(n); spin_.reserve(n);
+        leptonNumber_.reserve(n); baryonNumber_.reserve(n);
+        typeId_.reserve(n); classId_.reserve(n);
+    }
+
+    // Drops every row; interned names and classes are kept so ids stay stable across events
+    void clear() {
+        energy_.clear(); px_.clear(); py_.clear(); pz_.clear();
+        charge_.clear(); spin_.clear();
+        leptonNumber_.clear(); baryonNumber_.clear();
+        typeId_.clear(); classId_.clear();
+    }
+
+    // Reorders rows so that new row i is old row order[i]
+    void permute(const std::vector<std::size_t>& order) {
+        permuteColumn(energy_, order); permuteColumn(px_, order);
+        permuteColumn(py_, order); permuteColumn(pz_, order);
+        permuteColumn(charge_, order); permuteColumn(spin_, order);
+        permuteColumn(leptonNumber_, order); permuteColumn(baryonNumber_, order);
+        permuteColumn(typeId_, order); permuteColumn(classId_, order);
+    }
+
+    std::size_t size() const { return energy_.size(); }
+
+    std::uint16_t internType(std::string_view name) {
+        std::string key(name);
+        auto it = typeIds_.find(key);
+        if (it != typeIds_.end()) return it->second;
+        std::uint16_t id = static_cast<std::uint16_t>(firstInternedType + typeNames_.size());
+        typeNames_.push_back(key);
+        typeIds_.emplace(key, id);
+        return id;
+    }
+
+    std::uint16_t internClass(const std::type_info& type) {
+        std::type_index key(type);
+        for (std::size_t i = 0; i < classes_.size(); i++) {
+            if (classes_[i] == key) return static_cast<std::uint16_t>(i);
+        }
+        classes_.push_back(key);
+        return static_cast<std::uint16_t>(classes_.size() - 1);
+    }
+
+    // Type id of a getType() name, or npos for an unknown name
+    int findType(const std::string& name) const {
+        ParticleId id = findParticleId(name);
+        if (id != ParticleId::Unknown) return static_cast<int>(id);
+        auto it = typeIds_.find(name);
+        return it != typeIds_.end() ? static_cast<int>(it->second) : npos;
+    }
+
+    // Class id of a dynamic type, or npos if no particle of that class was ever added
+    int findClass(const std::type_info& type) const {
+        std::type_index key(type);
+        for (std::size_t i = 0; i < classes_.size(); i++) {
+            if (classes_[i] == key) return static_cast<int>(i);
+        }
+        return npos;
+    }
+
+    std::string_view typeName(std::uint16_t id) const {
+        return id < firstInternedType ? particleName(static_cast<ParticleId>(id)) : std::string_view(typeNames_[id - firstInternedType]);
+    }
+
+    // One past the largest type id in use
+    std::size_t typeCount() const { return firstInternedType + typeNames_.size(); }
+    std::size_t classCount() const { return classes_.size(); }
+
+    const std::vector<double>& energy() const { return energy_; }
+    const std::vector<double>& px() const { return px_; }
+    const std::vector<double>& py() const { return py_; }
+    const std::vector<double>& pz() const { return pz_; }
+    const std::vector<double>& charge() const { return charge_; }
+    const std::vector<double>& spin() const { return spin_; }
+    const std::vector<int>& leptonNumber() const { return leptonNumber_; }
+    const std::vector<int>& baryonNumber() const { return baryonNumber_; }
+    const std::vector<std::uint16_t>& typeId() const { return typeId_; }
+    const std::vector<std::uint16_t>& classId() const { return classId_; }
+};
+
+#endif // PARTICLE_COLUMNS_H
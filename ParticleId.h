@@ -0,0 +1,90 @@
+#ifndef PARTICLE_ID_H
+#define PARTICLE_ID_H
+
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+// Compact identifier for every particle flavour the catalogue knows about
+enum class ParticleId : std::uint8_t {
+    Up, AntiUp, Down, AntiDown, Charm, AntiCharm,
+    Strange, AntiStrange, Top, AntiTop, Bottom, AntiBottom,
+    Lepton, Electron, Muon, Tau, Neutrino,
+    WPlus, WMinus, Z0, Higgs, Photon, Gluon,
+    Unknown  // Particle classes defined outside this library
+};
+
+struct ParticleProperties {
+    std::string_view name;  // Value returned by getType()
+    double mass;            // MeV; quark masses are approximate mid-values
+    double charge;          // Units of e
+    double spin;
+    ParticleId antiparticle;
+};
+
+// Indexed by ParticleId; leptons are stored per class, so each one is its own entry
+inline constexpr ParticleProperties particleTable[] = {
+    {"Up", 2.3, 2.0 / 3.0, 0.5, ParticleId::AntiUp},
+    {"Anti-Up", 2.3, -2.0 / 3.0, 0.5, ParticleId::Up},
+    {"Down", 4.8, -1.0 / 3.0, 0.5, ParticleId::AntiDown},
+    {"Anti-Down", 4.8, 1.0 / 3.0, 0.5, ParticleId::Down},
+    {"Charm", 1275, 2.0 / 3.0, 0.5, ParticleId::AntiCharm},
+    {"Anti-Charm", 1275, -2.0 / 3.0, 0.5, ParticleId::Charm},
+    {"Strange", 95, -1.0 / 3.0, 0.5, ParticleId::AntiStrange},
+    {"Anti-Strange", 95, 1.0 / 3.0, 0.5, ParticleId::Strange},
+    {"Top", 173000, 2.0 / 3.0, 0.5, ParticleId::AntiTop},
+    {"Anti-Top", 173000, -2.0 / 3.0, 0.5, ParticleId::Top},
+    {"Bottom", 4180, -1.0 / 3.0, 0.5, ParticleId::AntiBottom},
+    {"Anti-Bottom", 4180, 1.0 / 3.0, 0.5, ParticleId::Bottom},
+    {"Lepton", 0, -1, 0.5, ParticleId::Lepton},
+    {"Electron", 0.511, -1, 0.5, ParticleId::Electron},
+    {"Muon", 105.66, -1, 0.5, ParticleId::Muon},
+    {"Tau", 1776.86, -1, 0.5, ParticleId::Tau},
+    {"Neutrino", 0, 0, 0.5, ParticleId::Neutrino},
+    {"W+", 80379, 1, 1, ParticleId::WMinus},
+    {"W-", 80379, -1, 1, ParticleId::WPlus},
+    {"Z0", 91188, 0, 1, ParticleId::Z0},
+    {"Higgs", 125100, 0, 0, ParticleId::Higgs},
+    {"Photon", 0, 0, 1, ParticleId::Photon},
+    {"Gluon", 0, 0, 1, ParticleId::Gluon},
+    {"Unknown", 0, 0, 0, ParticleId::Unknown},
+};
+
+static_assert(sizeof(particleTable) / sizeof(particleTable[0]) == static_cast<std::size_t>(ParticleId::Unknown) + 1,
+              "particleTable must have one entry per ParticleId");
+
+constexpr const ParticleProperties& particleProperties(ParticleId id) {
+    return particleTable[static_cast<std::size_t>(id)];
+}
+
+constexpr std::string_view particleName(ParticleId id) {
+    return particleProperties(id).name;
+}
+
+constexpr bool isQuark(ParticleId id) {
+    return id <= ParticleId::AntiBottom;
+}
+
+constexpr bool isBoson(ParticleId id) {
+    return id >= ParticleId::WPlus && id <= ParticleId::Gluon;
+}
+
+// Name lookup for callers that still pass flavours as strings; Unknown when not found
+constexpr ParticleId findParticleId(std::string_view name) {
+    for (std::size_t i = 0; i < static_cast<std::size_t>(ParticleId::Unknown); i++) {
+        if (particleTable[i].name == name) return static_cast<ParticleId>(i);
+    }
+    return ParticleId::Unknown;
+}
+
+inline ParticleId particleIdFromName(std::string_view name) {
+    ParticleId id = findParticleId(name);
+    if (id == ParticleId::Unknown) {
+        throw std::invalid_argument("Unknown particle type: " + std::string(name));
+    }
+    return id;
+}
+
+#endif // PARTICLE_ID_H
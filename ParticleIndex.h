@@ -0,0 +1,245 @@
+#ifndef PARTICLE_INDEX_H
+#define PARTICLE_INDEX_H
+
+#include "ParticleColumns.h"
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <vector>
+
+// (key, row) pairs kept in key order. Inserts go to an unsorted tail, which the inserting
+// side sorts and merges once it outgrows an eighth of the sorted part, so loading costs
+// amortized O(log n) per entry. Queries never modify the index and may run concurrently;
+// they binary-search the sorted part and scan the tail. settle() empties the tail, after
+// which queries run in O(log n + k).
+class SortedKeyIndex {
+private:
+    struct Entry {
+        double key;
+        std::size_t row;
+        bool operator<(const Entry& other) const { return key < other.key; }
+    };
+
+    static constexpr std::size_t minTail = 1024;
+
+    std::vector<Entry> entries_;
+    std::size_t sortedCount_ = 0;
+
+    void settleIfLarge() {
+        if (entries_.size() - sortedCount_ > minTail + sortedCount_ / 8) settle();
+    }
+
+public:
+    void insert(double key, std::size_t row) {
+        entries_.push_back({key, row});
+        settleIfLarge();
+    }
+
+    void settle() {
+        if (sortedCount_ == entries_.size()) return;
+        std::sort(entries_.begin() + sortedCount_, entries_.end());
+        std::inplace_merge(entries_.begin(), entries_.begin() + sortedCount_, entries_.end());
+        sortedCount_ = entries_.size();
+    }
+
+    void clear() {
+        entries_.clear();
+        sortedCount_ = 0;
+    }
+
+    std::size_t size() const { return entries_.size(); }
+    std::size_t pending() const { return entries_.size() - sortedCount_; }
+
+    // Replaces the keys of the rows flagged in changed with key(row). The other entries stay
+    // sorted; the changed ones move to the unsorted tail.
+    template<typename Key>
+    void rekey(const std::vector<std::uint8_t>& changed, Key&& key) {
+        std::vector<Entry> moved;
+        std::size_t kept = 0, keptSorted = 0;
+        for (std::size_t i = 0; i < entries_.size(); i++) {
+            Entry entry = entries_[i];
+            if (changed[entry.row]) {
+                moved.push_back({key(entry.row), entry.row});
+            } else {
+                entries_[kept++] = entry;
+                if (i < sortedCount_) keptSorted++;
+            }
+        }
+        if (moved.empty()) return;
+        sortedCount_ = keptSorted;
+        std::copy(moved.begin(), moved.end(), entries_.begin() + kept);
+        settleIfLarge();
+    }
+
+    // Calls fn(row) for every entry with lo <= key <= hi, in ascending key order
+    template<typename Fn>
+    void forEachInRange(double lo, double hi, Fn&& fn) const {
+        auto sortedEnd = entries_.begin() + sortedCount_;
+        auto it = std::lower_bound(entries_.begin(), sortedEnd, Entry{lo, 0});
+        std::vector<Entry> pending;
+        for (auto tail = sortedEnd; tail != entries_.end(); ++tail) {
+            if (tail->key >= lo && tail->key <= hi) pending.push_back(*tail);
+        }
+        std::sort(pending.begin(), pending.end());
+        auto next = pending.begin();
+        for (; it != sortedEnd && it->key <= hi; ++it) {
+            for (; next != pending.end() && *next < *it; ++next) fn(next->row);
+            fn(it->row);
+        }
+        for (; next != pending.end(); ++next) fn(next->row);
+    }
+};
+
+// Secondary indexes over catalogue rows: buckets per type name, per dynamic class and per
+// charge, each with its rows in insertion order. Energy and transverse-momentum key indexes
+// per bucket are optional (enableRangeIndexes), as they take about 160 bytes per row.
+class ParticleIndex {
+public:
+    struct Bucket {
+        std::vector<std::size_t> rows;
+        SortedKeyIndex energy;              // Empty unless range indexes are enabled
+        SortedKeyIndex transverseMomentum;  // Likewise
+
+        void addKeys(std::size_t row, double E, double pT) {
+            energy.insert(E, row);
+            transverseMomentum.insert(pT, row);
+        }
+
+        void clearKeys() {
+            energy = SortedKeyIndex();
+            transverseMomentum = SortedKeyIndex();
+        }
+
+        void clear() {
+            rows.clear();
+            energy.clear();
+            transverseMomentum.clear();
+        }
+
+        void settle() {
+            energy.settle();
+            transverseMomentum.settle();
+        }
+
+        void rekey(const ParticleColumns& columns, const std::vector<std::uint8_t>& changed) {
+            energy.rekey(changed, [&](std::size_t row) { return columns.energy()[row]; });
+            transverseMomentum.rekey(changed, [&](std::size_t row) { return std::hypot(columns.px()[row], columns.py()[row]); });
+        }
+    };
+
+private:
+    std::vector<Bucket> byType_;   // Indexed by ParticleColumns type id
+    std::vector<Bucket> byClass_;  // Indexed by ParticleColumns class id
+    std::map<int, Bucket> byCharge_;  // Keyed by charge in units of e/3
+    Bucket charged_;  // Every particle with non-zero charge
+    Bucket all_;
+    Bucket empty_;
+    bool rangeIndexes_ = false;
+
+    static Bucket& slot(std::vector<Bucket>& buckets, std::size_t id) {
+        if (id >= buckets.size()) buckets.resize(id + 1);
+        return buckets[id];
+    }
+
+    template<typename Fn>
+    void forEachBucketOf(const ParticleColumns& columns, std::size_t row, Fn&& fn) {
+        int charge = chargeKey(columns.charge()[row]);
+        fn(slot(byType_, columns.typeId()[row]));
+        fn(slot(byClass_, columns.classId()[row]));
+        fn(byCharge_[charge]);
+        if (charge != 0) fn(charged_);
+        fn(all_);
+    }
+
+    template<typename Fn>
+    void forEachBucket(Fn&& fn) {
+        for (Bucket& bucket : byType_) fn(bucket);
+        for (Bucket& bucket : byClass_) fn(bucket);
+        for (auto& entry : byCharge_) fn(entry.second);
+        fn(charged_);
+        fn(all_);
+    }
+
+    void addKeys(const ParticleColumns& columns, std::size_t row) {
+        double E = columns.energy()[row];
+        double pT = std::hypot(columns.px()[row], columns.py()[row]);
+        forEachBucketOf(columns, row, [&](Bucket& bucket) { bucket.addKeys(row, E, pT); });
+    }
+
+public:
+    static int chargeKey(double charge) {
+        return static_cast<int>(std::lround(charge * 3.0));
+    }
+
+    void add(const ParticleColumns& columns, std::size_t row) {
+        forEachBucketOf(columns, row, [&](Bucket& bucket) { bucket.rows.push_back(row); });
+        if (rangeIndexes_) addKeys(columns, row);
+    }
+
+    void clear() {
+        for (Bucket& bucket : byType_) bucket.clear();
+        for (Bucket& bucket : byClass_) bucket.clear();
+        byCharge_.clear();
+        charged_.clear();
+        all_.clear();
+    }
+
+    // Builds the energy and pT key indexes of every bucket from the current rows and keeps
+    // them up to date from then on
+    void enableRangeIndexes(const ParticleColumns& columns) {
+        if (rangeIndexes_) return;
+        rangeIndexes_ = true;
+        for (std::size_t row = 0; row < columns.size(); row++) addKeys(columns, row);
+        settle();
+    }
+
+    // Drops the key indexes and their memory
+    void disableRangeIndexes() {
+        rangeIndexes_ = false;
+        forEachBucket([](Bucket& bucket) { bucket.clearKeys(); });
+    }
+
+    bool hasRangeIndexes() const { return rangeIndexes_; }
+
+    // Merges pending key inserts, so that range queries need no tail scan
+    void settle() {
+        forEachBucket([](Bucket& bucket) { bucket.settle(); });
+    }
+
+    // Refreshes the energy and pT keys of rows whose momentum changed in place (changed is
+    // indexed by row); cheaper than rebuild() when only a few rows moved
+    void updateMomenta(const ParticleColumns& columns, const std::vector<std::uint8_t>& changed) {
+        if (!rangeIndexes_) return;
+        forEachBucket([&](Bucket& bucket) { bucket.rekey(columns, changed); });
+    }
+
+    // Needed whenever rows are reordered
+    void rebuild(const ParticleColumns& columns) {
+        clear();
+        for (std::size_t row = 0; row < columns.size(); row++) {
+            add(columns, row);
+        }
+        if (rangeIndexes_) settle();
+    }
+
+    const Bucket& type(std::uint16_t typeId) const {
+        return typeId < byType_.size() ? byType_[typeId] : empty_;
+    }
+
+    const Bucket& dynamicClass(std::uint16_t classId) const {
+        return classId < byClass_.size() ? byClass_[classId] : empty_;
+    }
+
+    const Bucket& charge(double charge) const {
+        auto it = byCharge_.find(chargeKey(charge));
+        return it != byCharge_.end() ? it->second : empty_;
+    }
+
+    const Bucket& charged() const { return charged_; }
+    const Bucket& all() const { return all_; }
+    const Bucket& none() const { return empty_; }
+};
+
+#endif // PARTICLE_INDEX_H
@@ -0,0 +1,345 @@
+#ifndef PARTICLE_QUERY_H
+#define PARTICLE_QUERY_H
+
+#include "CatalogueAggregates.h"
+#include "ParallelExecutor.h"
+#include "ParticleCatalogue.h"
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <typeinfo>
+#include <utility>
+#include <vector>
+
+// Row properties a query can filter and order by without calling into the particle
+enum class QueryKey { Energy, Pt, Pz, Charge, Mass };
+
+// Lazy query over a catalogue, e.g. the four most energetic isolated muons above 20 GeV:
+//
+//   catalogue.query().ofType<Muon>()
+//       .where([](const Particle& p) { return p.isIsolated(); })
+//       .inRange(QueryKey::Pt, 20000.0)
+//       .orderBy(QueryKey::Energy, true).limit(4)
+//       .particles();
+//
+// Building a query only records the steps. A terminal operation (count, sum, rows,
+// particles, forEach, map) then runs them all in one pass over the rows: the source is
+// the index bucket of the first type constraint, column ranges are checked before the
+// where() predicates, and only surviving rows reach the result. orderBy with a limit keeps
+// a bounded top-k buffer per block instead of sorting every match.
+//
+// With parallel(), blocks are scanned on the catalogue's thread count and combined in block
+// order, so results match the serial run; predicates and keys must then be thread-safe.
+// A query reads the catalogue when it runs and must not overlap modifications to it.
+class ParticleQuery {
+private:
+    struct Range {
+        QueryKey key;
+        double lo, hi;  // Inclusive
+    };
+
+    struct Candidate {
+        double key;
+        std::size_t row;
+    };
+
+    const ParticleCatalogue* catalogue_;
+    std::vector<const std::type_info*> classes_;
+    std::vector<std::string> typeNames_;
+    std::vector<Range> ranges_;
+    std::vector<std::function<bool(const Particle&)>> predicates_;
+    bool ordered_ = false;
+    bool descending_ = false;
+    QueryKey orderKey_ = QueryKey::Energy;
+    std::function<double(const Particle&)> orderFunction_;
+    std::size_t limit_ = std::numeric_limits<std::size_t>::max();
+    bool parallel_ = false;
+
+    // Constraints resolved against the catalogue when the query runs
+    struct Plan {
+        const std::vector<std::size_t>* source = nullptr;  // Rows to scan; nullptr scans every row
+        std::size_t size = 0;
+        std::vector<int> classIds, typeIds;  // Further equality checks
+        bool empty = false;
+    };
+
+    static double columnValue(const ParticleColumns& columns, QueryKey key, std::size_t row) {
+        switch (key) {
+        case QueryKey::Energy: return columns.energy()[row];
+        case QueryKey::Pt: return std::hypot(columns.px()[row], columns.py()[row]);
+        case QueryKey::Pz: return columns.pz()[row];
+        case QueryKey::Charge: return columns.charge()[row];
+        case QueryKey::Mass: {
+            double E = columns.energy()[row], px = columns.px()[row], py = columns.py()[row], pz = columns.pz()[row];
+            return std::sqrt(std::max(0.0, E * E - px * px - py * py - pz * pz));
+        }
+        }
+        return 0.0;
+    }
+
+    Plan plan() const {
+        const ParticleColumns& columns = catalogue_->getColumns();
+        Plan plan;
+        for (const std::type_info* type : classes_) {
+            int id = columns.findClass(*type);
+            if (id == ParticleColumns::npos) plan.empty = true;
+            plan.classIds.push_back(id);
+        }
+        for (const std::string& name : typeNames_) {
+            int id = columns.findType(name);
+            if (id == ParticleColumns::npos) plan.empty = true;
+            plan.typeIds.push_back(id);
+        }
+        if (plan.empty) return plan;
+        // The first type constraint selects the bucket to scan
+        if (!plan.classIds.empty()) {
+            plan.source = &catalogue_->index.dynamicClass(static_cast<std::uint16_t>(plan.classIds.front())).rows;
+            plan.classIds.erase(plan.classIds.begin());
+        } else if (!plan.typeIds.empty()) {
+            plan.source = &catalogue_->index.type(static_cast<std::uint16_t>(plan.typeIds.front())).rows;
+            plan.typeIds.erase(plan.typeIds.begin());
+        }
+        plan.size = plan.source ? plan.source->size() : columns.size();
+        return plan;
+    }
+
+    bool accepts(const Plan& plan, std::size_t row) const {
+        const ParticleColumns& columns = catalogue_->getColumns();
+        for (int id : plan.classIds) {
+            if (columns.classId()[row] != id) return false;
+        }
+        for (int id : plan.typeIds) {
+            if (columns.typeId()[row] != id) return false;
+        }
+        for (const Range& range : ranges_) {
+            double value = columnValue(columns, range.key, row);
+            if (!(value >= range.lo && value <= range.hi)) return false;
+        }
+        if (!predicates_.empty()) {
+            const Particle& particle = *catalogue_->getParticles()[row];
+            for (const auto& predicate : predicates_) {
+                if (!predicate(particle)) return false;
+            }
+        }
+        return true;
+    }
+
+    // Calls sink(row) for the accepted rows among plan positions [begin, end)
+    template<typename Sink>
+    void scan(const Plan& plan, std::size_t begin, std::size_t end, Sink&& sink) const {
+        for (std::size_t i = begin; i < end; i++) {
+            std::size_t row = plan.source ? (*plan.source)[i] : i;
+            if (accepts(plan, row)) {
+                if (!sink(row)) return;
+            }
+        }
+    }
+
+    // Runs fn(begin, end, block) over blocks of plan positions, serially or in parallel
+    template<typename Fn>
+    std::size_t forEachBlock(const Plan& plan, Fn&& fn) const {
+        ParallelExecutor executor(parallel_ ? catalogue_->getThreadCount() : 1);
+        executor.forEachRange(plan.size, fn);
+        return ParallelExecutor::blockCount(plan.size);
+    }
+
+    double orderValue(std::size_t row) const {
+        return orderFunction_ ? orderFunction_(*catalogue_->getParticles()[row]) : columnValue(catalogue_->getColumns(), orderKey_, row);
+    }
+
+    // NaN keys sort last in either direction, which keeps this a strict weak ordering
+    bool before(const Candidate& a, const Candidate& b) const {
+        bool aNaN = std::isnan(a.key), bNaN = std::isnan(b.key);
+        if (aNaN != bNaN) return bNaN;
+        if (!aNaN && a.key != b.key) return descending_ ? a.key > b.key : a.key < b.key;
+        return a.row < b.row;
+    }
+
+    // Keeps the best limit_ candidates; amortised O(1) per push
+    void pushBounded(std::vector<Candidate>& candidates, Candidate candidate) const {
+        candidates.push_back(candidate);
+        if (limit_ < candidates.size() / 2) {
+            auto less = [this](const Candidate& a, const Candidate& b) { return before(a, b); };
+            std::nth_element(candidates.begin(), candidates.begin() + limit_, candidates.end(), less);
+            candidates.resize(limit_);
+        }
+    }
+
+    // Selected rows in result order
+    std::vector<std::size_t> select() const {
+        Plan p = plan();
+        std::vector<std::size_t> rows;
+        if (p.empty || limit_ == 0) return rows;
+
+        if (!ordered_) {
+            std::vector<std::vector<std::size_t>> partials(ParallelExecutor::blockCount(p.size));
+            forEachBlock(p, [&](std::size_t begin, std::size_t end, std::size_t block) {
+                auto& partial = partials[block];
+                scan(p, begin, end, [&](std::size_t row) {
+                    partial.push_back(row);
+                    return partial.size() < limit_;
+                });
+            });
+            for (const auto& partial : partials) {
+                rows.insert(rows.end(), partial.begin(), partial.begin() + std::min(partial.size(), limit_ - rows.size()));
+                if (rows.size() == limit_) break;
+            }
+            return rows;
+        }
+
+        std::vector<std::vector<Candidate>> partials(ParallelExecutor::blockCount(p.size));
+        forEachBlock(p, [&](std::size_t begin, std::size_t end, std::size_t block) {
+            auto& partial = partials[block];
+            scan(p, begin, end, [&](std::size_t row) {
+                pushBounded(partial, {orderValue(row), row});
+                return true;
+            });
+        });
+        std::vector<Candidate> candidates;
+        for (const auto& partial : partials) {
+            for (const Candidate& candidate : partial) pushBounded(candidates, candidate);
+        }
+        auto less = [this](const Candidate& a, const Candidate& b) { return before(a, b); };
+        std::size_t keep = std::min(limit_, candidates.size());
+        std::partial_sort(candidates.begin(), candidates.begin() + keep, candidates.end(), less);
+        rows.reserve(keep);
+        for (std::size_t i = 0; i < keep; i++) rows.push_back(candidates[i].row);
+        return rows;
+    }
+
+public:
+    explicit ParticleQuery(const ParticleCatalogue& catalogue) : catalogue_(&catalogue) {}
+
+    // Exact dynamic class, as getParticlesByType
+    template<typename ParticleType>
+    ParticleQuery& ofType() {
+        classes_.push_back(&typeid(ParticleType));
+        return *this;
+    }
+
+    // getType() name, e.g. "Anti-Up"
+    ParticleQuery& ofTypeName(const std::string& type) {
+        typeNames_.push_back(type);
+        return *this;
+    }
+
+    // Keeps rows with lo <= key <= hi
+    ParticleQuery& inRange(QueryKey key, double lo, double hi = std::numeric_limits<double>::infinity()) {
+        ranges_.push_back({key, lo, hi});
+        return *this;
+    }
+
+    template<typename Predicate>
+    ParticleQuery& where(Predicate&& predicate) {
+        predicates_.emplace_back(std::forward<Predicate>(predicate));
+        return *this;
+    }
+
+    // Ties are broken by catalogue row, so the order is deterministic; NaN keys come last
+    ParticleQuery& orderBy(QueryKey key, bool descending = false) {
+        ordered_ = true;
+        descending_ = descending;
+        orderKey_ = key;
+        orderFunction_ = nullptr;
+        return *this;
+    }
+
+    ParticleQuery& orderBy(std::function<double(const Particle&)> key, bool descending = false) {
+        ordered_ = true;
+        descending_ = descending;
+        orderFunction_ = std::move(key);
+        return *this;
+    }
+
+    // First k rows in result order; with orderBy this is a top-k selection
+    ParticleQuery& limit(std::size_t k) {
+        limit_ = k;
+        return *this;
+    }
+
+    // Scan on the catalogue's thread count (see ParticleCatalogue::setThreadCount)
+    ParticleQuery& parallel(bool enabled = true) {
+        parallel_ = enabled;
+        return *this;
+    }
+
+    std::size_t count() const {
+        // Order only matters once a limit picks which rows are kept
+        if (limit_ != std::numeric_limits<std::size_t>::max()) return select().size();
+        Plan p = plan();
+        if (p.empty) return 0;
+        std::vector<std::size_t> partials(ParallelExecutor::blockCount(p.size), 0);
+        forEachBlock(p, [&](std::size_t begin, std::size_t end, std::size_t block) {
+            scan(p, begin, end, [&](std::size_t) {
+                partials[block]++;
+                return true;
+            });
+        });
+        std::size_t total = 0;
+        for (std::size_t partial : partials) total += partial;
+        return total;
+    }
+
+    // Compensated sum of the selected four-momenta
+    FourMomentum sum() const {
+        const ParticleColumns& columns = catalogue_->getColumns();
+        std::array<CompensatedSum, 4> total;
+        auto add = [&](std::array<CompensatedSum, 4>& sums, std::size_t row) {
+            sums[0].add(columns.energy()[row]);
+            sums[1].add(columns.px()[row]);
+            sums[2].add(columns.py()[row]);
+            sums[3].add(columns.pz()[row]);
+        };
+        if (limit_ != std::numeric_limits<std::size_t>::max()) {
+            for (std::size_t row : select()) add(total, row);
+        } else {
+            Plan p = plan();
+            if (p.empty) return FourMomentum();
+            std::vector<std::array<CompensatedSum, 4>> partials(ParallelExecutor::blockCount(p.size));
+            forEachBlock(p, [&](std::size_t begin, std::size_t end, std::size_t block) {
+                scan(p, begin, end, [&](std::size_t row) {
+                    add(partials[block], row);
+                    return true;
+                });
+            });
+            for (const auto& partial : partials) {
+                for (int k = 0; k < 4; k++) total[k].add(partial[k].value());
+            }
+        }
+        return FourMomentum::unchecked(total[0].value(), total[1].value(), total[2].value(), total[3].value());  // May round slightly spacelike
+    }
+
+    // Catalogue rows of the result
+    std::vector<std::size_t> rows() const {
+        return select();
+    }
+
+    std::vector<std::shared_ptr<Particle>> particles() const {
+        return catalogue_->particlesAt(select());
+    }
+
+    // Calls fn(particle) in result order on the calling thread
+    template<typename Fn>
+    void forEach(Fn&& fn) const {
+        const auto& all = catalogue_->getParticles();
+        for (std::size_t row : select()) fn(static_cast<const Particle&>(*all[row]));
+    }
+
+    template<typename Fn>
+    auto map(Fn&& fn) const -> std::vector<std::decay_t<decltype(fn(std::declval<const Particle&>()))>> {
+        std::vector<std::decay_t<decltype(fn(std::declval<const Particle&>()))>> result;
+        forEach([&](const Particle& particle) { result.push_back(fn(particle)); });
+        return result;
+    }
+};
+
+inline ParticleQuery ParticleCatalogue::query() const {
+    return ParticleQuery(*this);
+}
+
+#endif // PARTICLE_QUERY_H
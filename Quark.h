@@ -10,26 +10,44 @@
 
 class Quark : public Particle {
 protected:
-    std::string type_;
+    ParticleId id_;
     double charge_;
     double spin_;
     std::string colorCharge_;  // Color charge for quarks
     FourMomentum fourMomentum_;
     std::vector<std::shared_ptr<Particle>> decayProducts_; // Store decay products
 
+    static ParticleId checkedFlavour(ParticleId id) {
+        if (!isQuark(id)) {
+            throw std::invalid_argument("Not a quark flavour: " + std::string(particleName(id)));
+        }
+        return id;
+    }
+
 public:
     // Constructor to initialize quark properties including color charge
-    Quark(const std::string& type, double charge, double spin, const std::string& colorCharge, const FourMomentum& fourMomentum)
-        : type_(type), charge_(charge), spin_(spin), colorCharge_(colorCharge), fourMomentum_(fourMomentum) {
+    Quark(ParticleId id, double charge, double spin, const std::string& colorCharge, const FourMomentum& fourMomentum)
+        : id_(checkedFlavour(id)), charge_(charge), spin_(spin), colorCharge_(colorCharge), fourMomentum_(fourMomentum) {
+        PARTICLE_COUNT(QuarkConstructed);
         validateMass();
     }
 
+    // Charge and spin taken from the particle table
+    Quark(ParticleId id, const std::string& colorCharge, const FourMomentum& fourMomentum)
+        : Quark(id, particleProperties(id).charge, particleProperties(id).spin, colorCharge, fourMomentum) {}
+
+    // Flavour given by name, e.g. "Anti-Up"; looked up once in the particle table. Throws
+    // std::invalid_argument for names that are not quark flavours.
+    Quark(const std::string& type, double charge, double spin, const std::string& colorCharge, const FourMomentum& fourMomentum)
+        : Quark(particleIdFromName(type), charge, spin, colorCharge, fourMomentum) {}
+
     virtual ~Quark() {}
 
     double charge() const override { return charge_; }
     double spin() const override { return spin_; }
     FourMomentum getFourMomentum() const override { return fourMomentum_; }
-    std::string getType() const override { return type_; }
+    std::string_view getType() const override { return particleName(id_); }
+    ParticleId getId() const override { return id_; }
 
     // Getter and setter for color charge
     std::string getColorCharge() const { return colorCharge_; }
@@ -40,6 +58,10 @@ public:
         decayProducts_.push_back(particle);
     }
 
+    const std::vector<std::shared_ptr<Particle>>& getDecayProducts() const override {
+        return decayProducts_;
+    }
+
     // Display decay paths
     void printDecayProducts() const {
         if (decayProducts_.empty()) {
@@ -57,20 +79,17 @@ public:
         double expectedMass = getExpectedMass();
         double derivedMass = fourMomentum_.invariantMass();
         if (std::fabs(derivedMass - expectedMass) > 1e-3) {  // Allowing some tolerance
-            std::cerr << "Warning: Mass discrepancy for " << type_
-                      << ". Expected: " << expectedMass << " MeV, Derived: " << derivedMass << " MeV." << std::endl;
+            PARTICLE_COUNT(QuarkMassFlagged);
+            if (Validation::fail(ValidationIssue::MassMismatch, getType(), expectedMass, derivedMass)) {
+                std::cerr << "Warning: Mass discrepancy for " << getType()
+                          << ". Expected: " << expectedMass << " MeV, Derived: " << derivedMass << " MeV." << std::endl;
+            }
         }
     }
 
     double getExpectedMass() const {
-        // Quark masses are generally averages or ranges, these are approximate mid-values.
-        if (type_ == "Up" || type_ == "Anti-Up") return 2.3;
-        if (type_ == "Down" || type_ == "Anti-Down") return 4.8;
-        if (type_ == "Charm" || type_ == "Anti-Charm") return 1275;
-        if (type_ == "Strange" || type_ == "Anti-Strange") return 95;
-        if (type_ == "Top" || type_ == "Anti-Top") return 173000;
-        if (type_ == "Bottom" || type_ == "Anti-Bottom") return 4180;
-        return 0; // Should never be reached; ensures every quark type has a corresponding mass
+        // Quark masses are generally averages or ranges, the table holds approximate mid-values.
+        return particleProperties(id_).mass;
     }
 
     // Extended print function to include decay products
@@ -0,0 +1,164 @@
+#include "ResonanceSearch.h"
+#include "ParticleIndex.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <stdexcept>
+
+struct CombinationSearch::Partial {
+    double E = 0.0, px = 0.0, py = 0.0, pz = 0.0;
+    int charge = 0;
+    std::array<std::size_t, ParticleCombination::maxMultiplicity> rows{};
+
+    Partial with(const CombinationSearch& search, std::size_t depth, std::size_t j) const {
+        Partial next = *this;
+        next.E += search.energy_[j];
+        next.px += search.px_[j];
+        next.py += search.py_[j];
+        next.pz += search.pz_[j];
+        next.charge += search.charge_[j];
+        next.rows[depth] = search.rows_[j];
+        return next;
+    }
+
+    double massSquared() const {
+        return E * E - (px * px + py * py + pz * pz);
+    }
+};
+
+CombinationSearch::CombinationSearch(const ParticleColumns& columns, const std::vector<std::size_t>& candidateRows, const CombinationQuery& query)
+    : query_(query), totalCharge_(ParticleIndex::chargeKey(query.totalCharge)) {
+    if (query.multiplicity == 0 || query.multiplicity > ParticleCombination::maxMultiplicity) {
+        throw std::invalid_argument("Combination multiplicity must be between 1 and " + std::to_string(ParticleCombination::maxMultiplicity) + ".");
+    }
+    if (query.minMass > query.maxMass) {
+        throw std::invalid_argument("Combination mass window is empty.");
+    }
+    double lo = std::max(0.0, query.minMass);
+    minMassSquared_ = lo * lo;
+    maxMassSquared_ = query.maxMass * query.maxMass;
+
+    std::vector<int> acceptedCharges;
+    for (double charge : query.charges) acceptedCharges.push_back(ParticleIndex::chargeKey(charge));
+    for (std::size_t row : candidateRows) {
+        int charge = ParticleIndex::chargeKey(columns.charge()[row]);
+        if (!acceptedCharges.empty() && std::find(acceptedCharges.begin(), acceptedCharges.end(), charge) == acceptedCharges.end()) continue;
+        energy_.push_back(columns.energy()[row]);
+        px_.push_back(columns.px()[row]);
+        py_.push_back(columns.py()[row]);
+        pz_.push_back(columns.pz()[row]);
+        charge_.push_back(charge);
+        rows_.push_back(row);
+        maxAbsCharge_ = std::max(maxAbsCharge_, std::abs(charge));
+    }
+}
+
+// False when no extension by `remaining` more particles can land in the window
+bool CombinationSearch::viable(const Partial& partial, std::size_t remaining) const {
+    if (partial.massSquared() > maxMassSquared_) return false;
+    return !query_.requireTotalCharge || std::abs(totalCharge_ - partial.charge) <= static_cast<int>(remaining) * maxAbsCharge_;
+}
+
+// Tests the final particle of every combination extending partial with rows [start, end)
+void CombinationSearch::scanLast(const Partial& partial, std::size_t start, std::size_t end, std::vector<ParticleCombination>& out) const {
+    const std::size_t depth = query_.multiplicity - 1;
+    auto emit = [&](std::size_t j, double massSquared) {
+        if (query_.requireTotalCharge && partial.charge + charge_[j] != totalCharge_) return;
+        ParticleCombination combination;
+        combination.rows = partial.rows;
+        combination.rows[depth] = rows_[j];
+        combination.size = query_.multiplicity;
+        combination.mass = std::sqrt(massSquared);
+        out.push_back(combination);
+    };
+    std::size_t j = start;
+#if defined(FOURMOMENTUM_USE_AVX)
+    const __m256d E0 = _mm256_set1_pd(partial.E), X0 = _mm256_set1_pd(partial.px);
+    const __m256d Y0 = _mm256_set1_pd(partial.py), Z0 = _mm256_set1_pd(partial.pz);
+    const __m256d lo = _mm256_set1_pd(minMassSquared_), hi = _mm256_set1_pd(maxMassSquared_);
+    for (; j + 4 <= end; j += 4) {
+        __m256d E = _mm256_add_pd(E0, _mm256_loadu_pd(&energy_[j]));
+        __m256d X = _mm256_add_pd(X0, _mm256_loadu_pd(&px_[j]));
+        __m256d Y = _mm256_add_pd(Y0, _mm256_loadu_pd(&py_[j]));
+        __m256d Z = _mm256_add_pd(Z0, _mm256_loadu_pd(&pz_[j]));
+        __m256d m2 = _mm256_sub_pd(_mm256_mul_pd(E, E),
+            _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(X, X), _mm256_mul_pd(Y, Y)), _mm256_mul_pd(Z, Z)));
+        m2 = _mm256_max_pd(m2, _mm256_setzero_pd());
+        int mask = _mm256_movemask_pd(_mm256_and_pd(_mm256_cmp_pd(m2, lo, _CMP_GE_OQ), _mm256_cmp_pd(m2, hi, _CMP_LE_OQ)));
+        if (mask == 0) continue;
+        alignas(32) double masses[4];
+        _mm256_store_pd(masses, m2);
+        for (int lane = 0; lane < 4; lane++) {
+            if (mask & (1 << lane)) emit(j + lane, masses[lane]);
+        }
+    }
+#elif defined(FOURMOMENTUM_USE_SSE2)
+    const __m128d E0 = _mm_set1_pd(partial.E), X0 = _mm_set1_pd(partial.px);
+    const __m128d Y0 = _mm_set1_pd(partial.py), Z0 = _mm_set1_pd(partial.pz);
+    const __m128d lo = _mm_set1_pd(minMassSquared_), hi = _mm_set1_pd(maxMassSquared_);
+    for (; j + 2 <= end; j += 2) {
+        __m128d E = _mm_add_pd(E0, _mm_loadu_pd(&energy_[j]));
+        __m128d X = _mm_add_pd(X0, _mm_loadu_pd(&px_[j]));
+        __m128d Y = _mm_add_pd(Y0, _mm_loadu_pd(&py_[j]));
+        __m128d Z = _mm_add_pd(Z0, _mm_loadu_pd(&pz_[j]));
+        __m128d m2 = _mm_sub_pd(_mm_mul_pd(E, E), _mm_add_pd(_mm_add_pd(_mm_mul_pd(X, X), _mm_mul_pd(Y, Y)), _mm_mul_pd(Z, Z)));
+        m2 = _mm_max_pd(m2, _mm_setzero_pd());
+        int mask = _mm_movemask_pd(_mm_and_pd(_mm_cmpge_pd(m2, lo), _mm_cmple_pd(m2, hi)));
+        if (mask == 0) continue;
+        alignas(16) double masses[2];
+        _mm_store_pd(masses, m2);
+        if (mask & 1) emit(j, masses[0]);
+        if (mask & 2) emit(j + 1, masses[1]);
+    }
+#endif
+    for (; j < end; j++) {
+        double E = partial.E + energy_[j], X = partial.px + px_[j], Y = partial.py + py_[j], Z = partial.pz + pz_[j];
+        double m2 = std::max(0.0, E * E - (X * X + Y * Y + Z * Z));
+        if (m2 >= minMassSquared_ && m2 <= maxMassSquared_) emit(j, m2);
+    }
+}
+
+// partial holds depth particles; tries every row from start onwards as the next one
+void CombinationSearch::extend(const Partial& partial, std::size_t depth, std::size_t start, std::vector<ParticleCombination>& out) const {
+    const std::size_t k = query_.multiplicity;
+    if (depth + 1 == k) {
+        scanLast(partial, start, rows_.size(), out);
+        return;
+    }
+    const std::size_t remaining = k - depth - 1;  // Particles still to add after row j
+    for (std::size_t j = start; j + remaining < rows_.size(); j++) {
+        Partial next = partial.with(*this, depth, j);
+        if (viable(next, remaining)) extend(next, depth + 1, j + 1, out);
+    }
+}
+
+std::vector<ParticleCombination> CombinationSearch::run(const ParallelExecutor& executor) const {
+    const std::size_t n = rows_.size();
+    const std::size_t k = query_.multiplicity;
+    std::vector<ParticleCombination> result;
+    if (n < k) return result;
+
+    // One block per first row for k > 1: the work per block is very uneven, so blocks
+    // are kept small and handed out dynamically.
+    const std::size_t firstRows = n - k + 1;
+    const std::size_t blockSize = k == 1 ? ParallelExecutor::defaultBlockSize : 1;
+    std::vector<std::vector<ParticleCombination>> partials(ParallelExecutor::blockCount(firstRows, blockSize));
+    executor.forEachRange(firstRows, [&](std::size_t begin, std::size_t end, std::size_t block) {
+        if (k == 1) {
+            scanLast(Partial{}, begin, end, partials[block]);
+            return;
+        }
+        for (std::size_t i = begin; i < end; i++) {
+            Partial first = Partial{}.with(*this, 0, i);
+            if (viable(first, k - 1)) extend(first, 1, i + 1, partials[block]);
+        }
+    }, blockSize);
+
+    std::size_t total = 0;
+    for (const auto& partial : partials) total += partial.size();
+    result.reserve(total);
+    for (const auto& partial : partials) {
+        result.insert(result.end(), partial.begin(), partial.end());
+    }
+    return result;
+}
@@ -0,0 +1,62 @@
+#ifndef RESONANCE_SEARCH_H
+#define RESONANCE_SEARCH_H
+
+#include "ParticleColumns.h"
+#include "ParallelExecutor.h"
+#include <array>
+#include <cstddef>
+#include <limits>
+#include <string>
+#include <vector>
+
+// Selects the candidate particles and the mass window of a combinatorial search,
+// e.g. Z0 -> l+l-: multiplicity 2, types {"Electron", "Muon"}, totalCharge 0, window 81-101 GeV.
+struct CombinationQuery {
+    std::size_t multiplicity = 2;    // Particles per combination, 1 to maxMultiplicity
+    std::vector<std::string> types;  // Accepted getType() names; empty accepts every type
+    std::vector<double> charges;     // Accepted particle charges (units of e); empty accepts any
+    bool requireTotalCharge = false;
+    double totalCharge = 0.0;        // Summed charge of a combination, when required
+    double minMass = 0.0;
+    double maxMass = std::numeric_limits<double>::infinity();
+};
+
+struct ParticleCombination {
+    static constexpr std::size_t maxMultiplicity = 6;
+
+    std::array<std::size_t, maxMultiplicity> rows{};  // Catalogue rows in ascending order; first `size` are used
+    std::size_t size = 0;
+    double mass = 0.0;
+};
+
+// Enumerates k-combinations of catalogue rows whose summed four-momentum has an invariant
+// mass inside the query window. Candidates are copied into private columns once, so the
+// inner loop never constructs or validates a FourMomentum. Partial sums are pruned as soon
+// as their mass exceeds the window: for physical momenta (E >= |p|) adding a particle never
+// lowers the invariant mass. The last particle of each combination is scanned with SIMD.
+class CombinationSearch {
+private:
+    std::vector<double> energy_, px_, py_, pz_;
+    std::vector<int> charge_;  // Units of e/3, as in ParticleIndex
+    std::vector<std::size_t> rows_;
+    CombinationQuery query_;
+    double minMassSquared_, maxMassSquared_;
+    int totalCharge_;
+    int maxAbsCharge_ = 0;
+
+    struct Partial;
+    void extend(const Partial& partial, std::size_t depth, std::size_t start, std::vector<ParticleCombination>& out) const;
+    bool viable(const Partial& partial, std::size_t remaining) const;
+    void scanLast(const Partial& partial, std::size_t start, std::size_t end, std::vector<ParticleCombination>& out) const;
+
+public:
+    // candidateRows must be ascending; rows failing the charge selector are dropped here
+    CombinationSearch(const ParticleColumns& columns, const std::vector<std::size_t>& candidateRows, const CombinationQuery& query);
+
+    std::size_t candidateCount() const { return rows_.size(); }
+
+    // Combinations in lexicographic row order; the order does not depend on the thread count
+    std::vector<ParticleCombination> run(const ParallelExecutor& executor) const;
+};
+
+#endif // RESONANCE_SEARCH_H
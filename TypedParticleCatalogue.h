@@ -0,0 +1,188 @@
+#ifndef TYPED_PARTICLE_CATALOGUE_H
+#define TYPED_PARTICLE_CATALOGUE_H
+
+#include "Boson.h"
+#include "Lepton.h"
+#include "Particle.h"
+#include "ParticleCatalogue.h"
+#include "Quark.h"
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Non-virtual calls into the Particle interface of an object whose dynamic class is exactly
+// T, such as an element of a TypedParticleCatalogue store. The qualified calls bind at
+// compile time and inline, where p.charge() through a reference would be a virtual call.
+struct StaticDispatch {
+    template<typename T>
+    static double charge(const T& p) { checkConcrete<T>(); return p.T::charge(); }
+
+    template<typename T>
+    static double spin(const T& p) { checkConcrete<T>(); return p.T::spin(); }
+
+    template<typename T>
+    static FourMomentum fourMomentum(const T& p) { checkConcrete<T>(); return p.T::getFourMomentum(); }
+
+    template<typename T>
+    static ParticleId id(const T& p) { checkConcrete<T>(); return p.T::getId(); }
+
+    template<typename T>
+    static std::string_view type(const T& p) {
+        ParticleId particleId = id(p);
+        return particleId != ParticleId::Unknown ? particleName(particleId) : p.T::getType();
+    }
+
+    template<typename T>
+    static int leptonNumber(const T& p) { checkConcrete<T>(); return p.T::getLeptonNumber(); }
+
+    template<typename T>
+    static int baryonNumber(const T& p) { checkConcrete<T>(); return p.T::getBaryonNumber(); }
+
+    template<typename T>
+    static bool isStable(const T& p) { checkConcrete<T>(); return p.T::isStable(); }
+
+private:
+    template<typename T>
+    static void checkConcrete() {
+        static_assert(std::is_base_of<Particle, T>::value && !std::is_abstract<T>::value,
+                      "StaticDispatch needs the concrete particle class");
+    }
+};
+
+// Catalogue with one contiguous store per particle class, holding the particles by value.
+// Loops over a store know the exact class, so the built-in queries and visitors written with
+// StaticDispatch compile to direct, inlinable code; there is no shared_ptr per particle.
+// Particles whose class is a base of another kind (Lepton) are stored only as that exact
+// class. getParticles() and addTo() expose the same objects through the polymorphic
+// Particle interface, as handles that stay valid until the store is modified or cleared.
+template<typename... Kinds>
+class BasicTypedCatalogue {
+private:
+    static_assert(sizeof...(Kinds) > 0, "BasicTypedCatalogue needs at least one particle class");
+
+    std::tuple<std::vector<Kinds>...> stores_;
+
+    // Visits every store in declaration order
+    template<typename Fn>
+    void forEachStore(Fn&& fn) const {
+        std::apply([&](const auto&... store) { (fn(store), ...); }, stores_);
+    }
+
+    template<typename Fn>
+    void forEachStore(Fn&& fn) {
+        std::apply([&](auto&... store) { (fn(store), ...); }, stores_);
+    }
+
+    // Non-owning handle in the style of ParticleArena: no control block, no allocation
+    template<typename T>
+    static std::shared_ptr<Particle> handle(const T& particle) {
+        return std::shared_ptr<Particle>(std::shared_ptr<Particle>(), const_cast<T*>(&particle));
+    }
+
+public:
+    template<typename T>
+    std::vector<T>& of() {
+        return std::get<std::vector<T>>(stores_);
+    }
+
+    template<typename T>
+    const std::vector<T>& of() const {
+        return std::get<std::vector<T>>(stores_);
+    }
+
+    template<typename T, typename... Args>
+    T& emplace(Args&&... args) {
+        return of<T>().emplace_back(std::forward<Args>(args)...);
+    }
+
+    template<typename T>
+    void addParticle(T particle) {
+        of<T>().push_back(std::move(particle));
+    }
+
+    template<typename T>
+    void reserve(size_t n) {
+        of<T>().reserve(n);
+    }
+
+    size_t getTotalNumberOfParticles() const {
+        size_t total = 0;
+        forEachStore([&](const auto& store) { total += store.size(); });
+        return total;
+    }
+
+    void clear() {
+        forEachStore([](auto& store) { store.clear(); });
+    }
+
+    // Calls fn(const T&) for every particle, store by store; fn is instantiated per class,
+    // so a generic lambda sees the exact type
+    template<typename Fn>
+    void forEach(Fn&& fn) const {
+        forEachStore([&](const auto& store) {
+            for (const auto& particle : store) fn(particle);
+        });
+    }
+
+    template<typename T, typename Fn>
+    void forEachOf(Fn&& fn) const {
+        for (const T& particle : of<T>()) fn(particle);
+    }
+
+    template<typename T, typename Predicate>
+    size_t countIf(Predicate&& predicate) const {
+        size_t count = 0;
+        for (const T& particle : of<T>()) count += predicate(particle) ? 1 : 0;
+        return count;
+    }
+
+    FourMomentum getTotalFourMomentum() const {
+        double totalE = 0.0, totalPx = 0.0, totalPy = 0.0, totalPz = 0.0;
+        forEach([&](const auto& particle) {
+            FourMomentum p = StaticDispatch::fourMomentum(particle);
+            totalE += p.data()[0];
+            totalPx += p.data()[1];
+            totalPy += p.data()[2];
+            totalPz += p.data()[3];
+        });
+        return FourMomentum::unchecked(totalE, totalPx, totalPy, totalPz);  // May round slightly spacelike
+    }
+
+    double getTotalCharge() const {
+        double total = 0.0;
+        forEach([&](const auto& particle) { total += StaticDispatch::charge(particle); });
+        return total;
+    }
+
+    std::unordered_map<std::string, int> getParticleCounts() const {
+        std::unordered_map<std::string_view, int> byName;
+        forEach([&](const auto& particle) { byName[StaticDispatch::type(particle)]++; });
+        std::unordered_map<std::string, int> counts;
+        for (const auto& entry : byName) counts[std::string(entry.first)] = entry.second;
+        return counts;
+    }
+
+    // Polymorphic view of every particle, store by store
+    std::vector<std::shared_ptr<Particle>> getParticles() const {
+        std::vector<std::shared_ptr<Particle>> result;
+        result.reserve(getTotalNumberOfParticles());
+        forEach([&](const auto& particle) { result.push_back(handle(particle)); });
+        return result;
+    }
+
+    // Adds handles to every particle to a ParticleCatalogue for its indexed queries
+    void addTo(ParticleCatalogue& catalogue) const {
+        catalogue.reserve(catalogue.getTotalNumberOfParticles() + getTotalNumberOfParticles());
+        forEach([&](const auto& particle) { catalogue.addParticle(handle(particle)); });
+    }
+};
+
+using TypedParticleCatalogue = BasicTypedCatalogue<Quark, Lepton, Electron, Muon, Tau, Neutrino, Boson>;
+
+#endif // TYPED_PARTICLE_CATALOGUE_H
@@ -0,0 +1,31 @@
+#include "Validation.h"
+#include "ValidationReport.h"
+
+ValidationReport& Validation::processReport() {
+    static ValidationReport report;
+    return report;
+}
+
+Validation::Policy& Validation::current() {
+    thread_local Policy policy{defaultValidationMode, nullptr};
+    return policy;
+}
+
+bool Validation::fail(ValidationIssue issue, std::string_view type, double expected, double found) {
+    const Policy& policy = current();
+    ValidationReport& report = policy.report ? *policy.report : processReport();
+    switch (policy.mode) {
+    case ValidationMode::Off:
+        return false;
+    case ValidationMode::CountOnly:
+        report.add(issue);
+        return false;
+    case ValidationMode::Collect:
+        report.collect({issue, type, expected, found});
+        return false;
+    case ValidationMode::Strict:
+        report.add(issue);
+        return true;
+    }
+    return true;
+}
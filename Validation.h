@@ -0,0 +1,82 @@
+#ifndef VALIDATION_H
+#define VALIDATION_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+// How physics checks in constructors report a failure:
+//   Off       - failures are ignored
+//   CountOnly - failures are counted in the active ValidationReport
+//   Collect   - failures are counted and kept as diagnostics in the active ValidationReport
+//   Strict    - failures are counted, logged to std::cerr, and E < |p| throws (the original behaviour)
+// Corrections such as Electron's energy adjustment are applied in every mode.
+enum class ValidationMode : std::uint8_t { Off, CountOnly, Collect, Strict };
+
+// Build-wide default, e.g. -DPARTICLE_VALIDATION_DEFAULT=CountOnly
+#ifndef PARTICLE_VALIDATION_DEFAULT
+#define PARTICLE_VALIDATION_DEFAULT Strict
+#endif
+inline constexpr ValidationMode defaultValidationMode = ValidationMode::PARTICLE_VALIDATION_DEFAULT;
+
+enum class ValidationIssue : std::uint8_t {
+    EnergyBelowMomentum,  // FourMomentum with E < |p|
+    MassMismatch,         // Quark or Boson mass differs from the particle table
+    CalorimeterMismatch,  // Electron calorimeter layers do not add up to E
+};
+
+constexpr std::size_t validationIssueCount = 3;
+
+constexpr std::string_view validationIssueName(ValidationIssue issue) {
+    switch (issue) {
+    case ValidationIssue::EnergyBelowMomentum: return "EnergyBelowMomentum";
+    case ValidationIssue::MassMismatch: return "MassMismatch";
+    case ValidationIssue::CalorimeterMismatch: return "CalorimeterMismatch";
+    }
+    return "Unknown";
+}
+
+struct ValidationDiagnostic {
+    ValidationIssue issue;
+    std::string_view type;  // getType() of the particle, empty for a bare FourMomentum
+    double expected;        // |p| for EnergyBelowMomentum, otherwise the expected mass or energy
+    double found;
+};
+
+class ValidationReport;  // ValidationReport.h
+
+// The policy in force on the current thread. Checks stay a single comparison on the hot
+// path; the policy is only consulted once a check has failed, so its state and the
+// reporting live in Validation.cpp.
+class Validation {
+public:
+    struct Policy {
+        ValidationMode mode;
+        ValidationReport* report;  // nullptr selects processReport()
+    };
+
+    static ValidationReport& processReport();
+    static Policy& current();
+
+    // Records a failed check under the current policy. Returns true in Strict mode, where
+    // the caller keeps its original logging (and throwing) behaviour.
+    static bool fail(ValidationIssue issue, std::string_view type, double expected, double found);
+};
+
+// Installs a policy on the current thread for the lifetime of the scope
+class ValidationScope {
+private:
+    Validation::Policy saved_;
+
+public:
+    ValidationScope(ValidationMode mode, ValidationReport* report = nullptr) : saved_(Validation::current()) {
+        Validation::current() = {mode, report};
+    }
+
+    ~ValidationScope() { Validation::current() = saved_; }
+
+    ValidationScope(const ValidationScope&) = delete;
+    ValidationScope& operator=(const ValidationScope&) = delete;
+};
+
+#endif // VALIDATION_H
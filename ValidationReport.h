@@ -0,0 +1,114 @@
+#ifndef VALIDATION_REPORT_H
+#define VALIDATION_REPORT_H
+
+#include "Validation.h"
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+#include <ostream>
+#include <vector>
+
+// Failure counts and diagnostics of one catalogue (or of the whole process, see
+// Validation::processReport). Safe to record into from several threads. Copies and moves
+// take a consistent snapshot of the source, so catalogues holding a report stay copyable.
+class ValidationReport {
+private:
+    std::array<std::atomic<std::size_t>, validationIssueCount> counts_{};
+    std::vector<ValidationDiagnostic> diagnostics_;
+    std::atomic<std::size_t> droppedDiagnostics_{0};
+    mutable std::mutex mutex_;
+
+    // Counts are only zeroed under the mutex, so holding both locks gives a consistent copy
+    void assignFrom(const ValidationReport& other) {
+        for (std::size_t i = 0; i < validationIssueCount; i++) {
+            counts_[i].store(other.counts_[i].load(std::memory_order_relaxed), std::memory_order_relaxed);
+        }
+        droppedDiagnostics_.store(other.droppedDiagnostics_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    }
+
+public:
+    static constexpr std::size_t maxDiagnostics = 100000;  // Further diagnostics are only counted
+
+    ValidationReport() = default;
+
+    ValidationReport(const ValidationReport& other) {
+        std::lock_guard<std::mutex> lock(other.mutex_);
+        assignFrom(other);
+        diagnostics_ = other.diagnostics_;
+    }
+
+    ValidationReport(ValidationReport&& other) {
+        std::lock_guard<std::mutex> lock(other.mutex_);
+        assignFrom(other);
+        diagnostics_ = std::move(other.diagnostics_);
+    }
+
+    ValidationReport& operator=(const ValidationReport& other) {
+        if (this == &other) return *this;
+        std::scoped_lock lock(mutex_, other.mutex_);
+        assignFrom(other);
+        diagnostics_ = other.diagnostics_;
+        return *this;
+    }
+
+    ValidationReport& operator=(ValidationReport&& other) {
+        if (this == &other) return *this;
+        std::scoped_lock lock(mutex_, other.mutex_);
+        assignFrom(other);
+        diagnostics_ = std::move(other.diagnostics_);
+        return *this;
+    }
+
+    void add(ValidationIssue issue) {
+        counts_[static_cast<std::size_t>(issue)].fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void collect(const ValidationDiagnostic& diagnostic) {
+        add(diagnostic.issue);
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (diagnostics_.size() < maxDiagnostics) {
+            diagnostics_.push_back(diagnostic);
+        } else {
+            droppedDiagnostics_.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    std::size_t count(ValidationIssue issue) const {
+        return counts_[static_cast<std::size_t>(issue)].load(std::memory_order_relaxed);
+    }
+
+    std::size_t totalCount() const {
+        std::size_t total = 0;
+        for (const auto& c : counts_) total += c.load(std::memory_order_relaxed);
+        return total;
+    }
+
+    std::size_t droppedDiagnostics() const { return droppedDiagnostics_.load(std::memory_order_relaxed); }
+
+    std::vector<ValidationDiagnostic> diagnostics() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return diagnostics_;
+    }
+
+    void clear() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (auto& c : counts_) c.store(0, std::memory_order_relaxed);
+        diagnostics_.clear();
+        droppedDiagnostics_.store(0, std::memory_order_relaxed);
+    }
+
+    void print(std::ostream& out) const {
+        out << "Validation report:\n";
+        for (std::size_t i = 0; i < validationIssueCount; i++) {
+            out << "  " << validationIssueName(static_cast<ValidationIssue>(i)) << ": " << count(static_cast<ValidationIssue>(i)) << "\n";
+        }
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (const ValidationDiagnostic& d : diagnostics_) {
+            out << "  " << validationIssueName(d.issue) << " " << d.type << " expected " << d.expected << ", found " << d.found << "\n";
+        }
+        if (droppedDiagnostics()) out << "  (" << droppedDiagnostics() << " more diagnostics not kept)\n";
+    }
+};
+
+#endif // VALIDATION_REPORT_H
@@ -0,0 +1,77 @@
+// Compares building and tearing down events with std::make_shared against the
+// catalogue's event arena. Each event holds quarks, a Z0 -> mu mu decay and a tau decay.
+// Usage: ArenaAllocationBenchmark [events] [quarksPerEvent]
+#include "../Quark.h"
+#include "../Lepton.h"
+#include "../Boson.h"
+#include "../ParticleCatalogue.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+namespace {
+
+double energy(double mass, double pz) {
+    return std::sqrt(mass * mass + pz * pz);
+}
+
+// Allocates either with make_shared (useArena == false) or inside the catalogue arena
+template<bool useArena>
+struct Factory {
+    ParticleCatalogue& catalogue;
+
+    template<typename T, typename... Args>
+    std::shared_ptr<T> make(Args&&... args) {
+        if constexpr (useArena) {
+            return catalogue.getArena().create<T>(std::forward<Args>(args)...).share();
+        } else {
+            return std::make_shared<T>(std::forward<Args>(args)...);
+        }
+    }
+};
+
+template<bool useArena>
+void buildEvent(ParticleCatalogue& catalogue, size_t quarks) {
+    Factory<useArena> factory{catalogue};
+    for (size_t i = 0; i < quarks; i++) {
+        double pz = static_cast<double>(i);
+        catalogue.addParticle(factory.template make<Quark>("Up", 2 / 3.0, 0.5, "Red", FourMomentum(energy(2.3, pz), 0, 0, pz)));
+    }
+    auto z = factory.template make<Boson>("Z0", 0.0, 1.0, FourMomentum(91188.0, 0, 0, 0));
+    double p = std::sqrt(91188.0 * 91188.0 / 4 - 105.66 * 105.66);
+    z->addDecayProduct(factory.template make<Muon>(-1.0, 0.5, FourMomentum(45594.0, 0, 0, p), true));
+    z->addDecayProduct(factory.template make<Muon>(1.0, 0.5, FourMomentum(45594.0, 0, 0, -p), true));
+    catalogue.addParticle(z);
+
+    auto tau = factory.template make<Tau>(-1.0, 0.5, FourMomentum(energy(1776.86, 100.0), 0, 0, 100.0));
+    tau->setDecayProducts({factory.template make<Muon>(-1.0, 0.5, FourMomentum(energy(105.66, 50.0), 0, 0, 50.0), false),
+                           factory.template make<Neutrino>(0.0, 0.5, 1, FourMomentum(25.0, 0, 0, 25.0))});
+    catalogue.addParticle(tau);
+}
+
+template<bool useArena>
+double run(size_t events, size_t quarks) {
+    ParticleCatalogue catalogue;
+    auto start = std::chrono::steady_clock::now();
+    for (size_t e = 0; e < events; e++) {
+        buildEvent<useArena>(catalogue, quarks);
+        catalogue.clear();
+    }
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    size_t events = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 20000;
+    size_t quarks = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 100;
+    const double particlesPerEvent = static_cast<double>(quarks + 6);
+
+    double sharedSeconds = run<false>(events, quarks);
+    double arenaSeconds = run<true>(events, quarks);
+    std::printf("events=%zu particles/event=%.0f\n", events, particlesPerEvent);
+    std::printf("%-12s %10.3f s %14.0f particles/s\n", "make_shared", sharedSeconds, events * particlesPerEvent / sharedSeconds);
+    std::printf("%-12s %10.3f s %14.0f particles/s\n", "arena", arenaSeconds, events * particlesPerEvent / arenaSeconds);
+    std::printf("speedup      %10.2fx\n", sharedSeconds / arenaSeconds);
+    return 0;
+}
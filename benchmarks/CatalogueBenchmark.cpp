@@ -0,0 +1,412 @@
+// Microbenchmark suite for FourMomentum arithmetic, particle construction, catalogue
+// queries and export. Every benchmark runs at each decade size from --min-size to --max-size and the
+// results are written as JSON (default) or CSV for regression tracking.
+//
+// Usage: CatalogueBenchmark [--min-size N] [--max-size N] [--repetitions R]
+//                           [--format json|csv] [--output PATH] [--filter SUBSTRING]
+//
+// Sizes up to 1e8 are supported; a catalogue of 1e8 particles needs tens of GB of memory,
+// so the default stops at 1e6.
+#include "../Quark.h"
+#include "../Lepton.h"
+#include "../Boson.h"
+#include "../ParticleCatalogue.h"
+#include "../ParticleQuery.h"
+#include "../Instrumentation.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+volatile double sink;  // Keeps benchmark results observable so loops are not optimized away
+
+struct Options {
+    size_t minSize = 1000;
+    size_t maxSize = 1000000;
+    int repetitions = 5;
+    std::string format = "json";
+    std::string output;  // Standard output when empty
+    std::string filter;
+};
+
+struct Result {
+    std::string name;
+    size_t size;
+    int repetitions;
+    double bestSeconds;
+    double meanSeconds;
+};
+
+class Suite {
+private:
+    const Options& options_;
+    std::vector<Result> results_;
+
+public:
+    explicit Suite(const Options& options) : options_(options) {}
+
+    bool enabled(const std::string& name) const {
+        return options_.filter.empty() || name.find(options_.filter) != std::string::npos;
+    }
+
+    // Times body() over the configured repetitions; setup() runs untimed before each one
+    template<typename Setup, typename Body>
+    void measure(const std::string& name, size_t size, Setup&& setup, Body&& body) {
+        if (!enabled(name)) return;
+        double best = 0.0, total = 0.0;
+        for (int r = 0; r < options_.repetitions; r++) {
+            setup();
+            auto start = std::chrono::steady_clock::now();
+            body();
+            double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            best = r == 0 ? seconds : std::min(best, seconds);
+            total += seconds;
+        }
+        results_.push_back({name, size, options_.repetitions, best, total / options_.repetitions});
+        std::cerr << name << " n=" << size << ": " << best * 1e9 / size << " ns/item" << std::endl;
+    }
+
+    template<typename Body>
+    void measure(const std::string& name, size_t size, Body&& body) {
+        measure(name, size, [] {}, std::forward<Body>(body));
+    }
+
+    void write(std::ostream& out) const {
+#if defined(FOURMOMENTUM_USE_AVX)
+        const char* simd = "avx";
+#elif defined(FOURMOMENTUM_USE_SSE2)
+        const char* simd = "sse2";
+#else
+        const char* simd = "scalar";
+#endif
+        char line[512];
+        if (options_.format == "csv") {
+            out << "name,size,repetitions,best_seconds,mean_seconds,ns_per_item\n";
+            for (const Result& r : results_) {
+                std::snprintf(line, sizeof(line), "%s,%zu,%d,%.9g,%.9g,%.6g\n",
+                              r.name.c_str(), r.size, r.repetitions, r.bestSeconds, r.meanSeconds, r.bestSeconds * 1e9 / r.size);
+                out << line;
+            }
+            return;
+        }
+        out << "{\n  \"context\": {\"simd\": \"" << simd << "\", \"hardware_threads\": " << std::thread::hardware_concurrency() << "},\n";
+        out << "  \"benchmarks\": [";
+        for (size_t i = 0; i < results_.size(); i++) {
+            const Result& r = results_[i];
+            std::snprintf(line, sizeof(line),
+                          "%s\n    {\"name\": \"%s\", \"size\": %zu, \"repetitions\": %d, \"best_seconds\": %.9g, \"mean_seconds\": %.9g, \"ns_per_item\": %.6g}",
+                          i ? "," : "", r.name.c_str(), r.size, r.repetitions, r.bestSeconds, r.meanSeconds, r.bestSeconds * 1e9 / r.size);
+            out << line;
+        }
+        out << "\n  ]";
+        if (Instrumentation::enabled) out << ",\n  \"instrumentation\": " << Instrumentation::snapshot().toJson();
+        out << "\n}\n";
+    }
+};
+
+double energy(double mass, double px, double py, double pz) {
+    return std::sqrt(mass * mass + px * px + py * py + pz * pz);
+}
+
+// Random on-shell four-momenta for a particle of the given mass
+std::vector<FourMomentum> momenta(size_t n, double mass, std::mt19937_64& rng) {
+    std::uniform_real_distribution<double> momentum(-50000.0, 50000.0);
+    std::vector<FourMomentum> result;
+    result.reserve(n);
+    for (size_t i = 0; i < n; i++) {
+        double px = momentum(rng), py = momentum(rng), pz = momentum(rng);
+        result.emplace_back(energy(mass, px, py, pz), px, py, pz);
+    }
+    return result;
+}
+
+void fourMomentumBenchmarks(Suite& suite, size_t n, std::mt19937_64& rng) {
+    std::vector<FourMomentum> a = momenta(n, 105.66, rng), b = momenta(n, 0.511, rng);
+    std::vector<FourMomentum> out(n);
+    std::vector<double> masses(n);
+
+    suite.measure("FourMomentum/add", n, [&] {
+        for (size_t i = 0; i < n; i++) out[i] = a[i] + b[i];
+        sink = out[n - 1].data()[0];
+    });
+    suite.measure("FourMomentum/subtract", n, [&] {
+        for (size_t i = 0; i < n; i++) out[i] = a[i] - b[i];
+        sink = out[n - 1].data()[0];
+    });
+    suite.measure("FourMomentum/dot", n, [&] {
+        double total = 0.0;
+        for (size_t i = 0; i < n; i++) total += a[i] * b[i];
+        sink = total;
+    });
+    suite.measure("FourMomentum/invariantMass", n, [&] {
+        double total = 0.0;
+        for (size_t i = 0; i < n; i++) total += a[i].invariantMass();
+        sink = total;
+    });
+    suite.measure("FourMomentum/addBatch", n, [&] {
+        FourMomentum::addBatch(a.data(), b.data(), out.data(), n);
+        sink = out[n - 1].data()[0];
+    });
+    suite.measure("FourMomentum/invariantMassBatch", n, [&] {
+        FourMomentum::invariantMassBatch(a.data(), masses.data(), n);
+        sink = masses[n - 1];
+    });
+}
+
+void constructionBenchmarks(Suite& suite, size_t n, std::mt19937_64& rng) {
+    const double upMass = particleProperties(ParticleId::Up).mass;
+    const double electronMass = particleProperties(ParticleId::Electron).mass;
+    const double zMass = particleProperties(ParticleId::Z0).mass;
+    std::vector<FourMomentum> up = momenta(n, upMass, rng), electrons = momenta(n, electronMass, rng);
+    std::vector<FourMomentum> muons = momenta(n, 105.66, rng), taus = momenta(n, 1776.86, rng), zs = momenta(n, zMass, rng);
+    // Calorimeter layers that add up to each electron's energy, so the check passes
+    std::vector<std::vector<double>> layers(n);
+    for (size_t i = 0; i < n; i++) {
+        double E = electrons[i].data()[0];
+        layers[i] = {0.5 * E, 0.3 * E, 0.2 * E};
+    }
+
+    // Constructors run validateMass / the calorimeter check; charge() is summed so the
+    // objects cannot be elided
+    suite.measure("Construct/Quark", n, [&] {
+        double total = 0.0;
+        for (size_t i = 0; i < n; i++) total += Quark(ParticleId::Up, "Red", up[i]).charge();
+        sink = total;
+    });
+    suite.measure("Construct/Lepton", n, [&] {
+        double total = 0.0;
+        for (size_t i = 0; i < n; i++) total += Lepton(-1.0, 0.5, 1, muons[i]).charge();
+        sink = total;
+    });
+    suite.measure("Construct/Electron", n, [&] {
+        double total = 0.0;
+        for (size_t i = 0; i < n; i++) total += Electron(-1.0, 0.5, electrons[i], layers[i]).charge();
+        sink = total;
+    });
+    // Per-electron vectors and constructor checks against the catalogue's shared layer store
+    // and one batch check; a tenth of the electrons need their momentum corrected
+    std::vector<std::vector<double>> mismatched = layers;
+    for (size_t i = 0; i < n; i += 10) mismatched[i][0] *= 1.01;
+    ParticleCatalogue calorimeterCatalogue;
+    calorimeterCatalogue.setValidationMode(ValidationMode::CountOnly);
+    suite.measure("Calorimeter/addElectron", n, [&] { calorimeterCatalogue.clear(); }, [&] {
+        ValidationScope scope = calorimeterCatalogue.validationScope();
+        for (size_t i = 0; i < n; i++) calorimeterCatalogue.addParticle(std::make_shared<Electron>(-1.0, 0.5, electrons[i], mismatched[i]));
+    });
+    suite.measure("Calorimeter/createElectron+reconcile", n, [&] { calorimeterCatalogue.clear(); }, [&] {
+        for (size_t i = 0; i < n; i++) calorimeterCatalogue.createElectron(-1.0, 0.5, electrons[i], mismatched[i]);
+        sink = static_cast<double>(calorimeterCatalogue.reconcileCalorimeters().size());
+    });
+    suite.measure("Calorimeter/reconcile", n, [&] {
+        calorimeterCatalogue.clear();
+        for (size_t i = 0; i < n; i++) calorimeterCatalogue.createElectron(-1.0, 0.5, electrons[i], mismatched[i]);
+    }, [&] {
+        sink = static_cast<double>(calorimeterCatalogue.reconcileCalorimeters().size());
+    });
+    suite.measure("Construct/Muon", n, [&] {
+        double total = 0.0;
+        for (size_t i = 0; i < n; i++) total += Muon(-1.0, 0.5, muons[i], true).charge();
+        sink = total;
+    });
+    suite.measure("Construct/Tau", n, [&] {
+        double total = 0.0;
+        for (size_t i = 0; i < n; i++) total += Tau(-1.0, 0.5, taus[i]).charge();
+        sink = total;
+    });
+    suite.measure("Construct/Neutrino", n, [&] {
+        double total = 0.0;
+        for (size_t i = 0; i < n; i++) total += Neutrino(0.0, 0.5, 1, muons[i]).spin();
+        sink = total;
+    });
+    suite.measure("Construct/Boson", n, [&] {
+        double total = 0.0;
+        for (size_t i = 0; i < n; i++) total += Boson(ParticleId::Z0, zs[i]).spin();
+        sink = total;
+    });
+    suite.measure("Construct/make_shared<Muon>", n, [&] {
+        double total = 0.0;
+        for (size_t i = 0; i < n; i++) total += std::make_shared<Muon>(-1.0, 0.5, muons[i], true)->charge();
+        sink = total;
+    });
+    suite.measure("Quark/validateMass", n, [&] {
+        Quark quark(ParticleId::Up, "Red", up[0]);
+        for (size_t i = 0; i < n; i++) quark.validateMass();
+        sink = quark.charge();
+    });
+}
+
+// A mix of muons, electrons, quarks and Z bosons in random order
+std::vector<std::shared_ptr<Particle>> mixedParticles(size_t n, std::mt19937_64& rng) {
+    std::uniform_real_distribution<double> momentum(-50000.0, 50000.0);
+    std::vector<std::shared_ptr<Particle>> particles;
+    particles.reserve(n);
+    for (size_t i = 0; i < n; i++) {
+        double px = momentum(rng), py = momentum(rng), pz = momentum(rng);
+        double charge = rng() % 2 ? 1.0 : -1.0;
+        switch (rng() % 4) {
+        case 0:
+            particles.push_back(std::make_shared<Muon>(charge, 0.5, FourMomentum(energy(105.66, px, py, pz), px, py, pz), true));
+            break;
+        case 1: {
+            double E = energy(0.511, px, py, pz);
+            particles.push_back(std::make_shared<Electron>(charge, 0.5, FourMomentum(E, px, py, pz), std::vector<double>{0.6 * E, 0.4 * E}));
+            break;
+        }
+        case 2:
+            particles.push_back(std::make_shared<Quark>(ParticleId::Charm, "Green", FourMomentum(energy(1275, px, py, pz), px, py, pz)));
+            break;
+        default:
+            particles.push_back(std::make_shared<Boson>(ParticleId::Z0, FourMomentum(energy(91188, px, py, pz), px, py, pz)));
+            break;
+        }
+    }
+    return particles;
+}
+
+void catalogueBenchmarks(Suite& suite, size_t n, std::mt19937_64& rng) {
+    std::vector<std::shared_ptr<Particle>> particles = mixedParticles(n, rng);
+    ParticleCatalogue catalogue;
+    suite.measure("Catalogue/addParticle", n, [&] { catalogue.clear(); }, [&] {
+        for (const auto& particle : particles) catalogue.addParticle(particle);
+    });
+    if (catalogue.getTotalNumberOfParticles() != n) {
+        for (const auto& particle : particles) catalogue.addParticle(particle);
+    }
+
+    suite.measure("Catalogue/getTotalFourMomentum", n, [&] {
+        sink = catalogue.getTotalFourMomentum().data()[0];
+    });
+    suite.measure("Catalogue/getTotalFourMomentumParallel", n, [&] {
+        sink = catalogue.getTotalFourMomentumParallel().data()[0];
+    });
+    suite.measure("Catalogue/getParticleCounts", n, [&] {
+        sink = static_cast<double>(catalogue.getParticleCounts().size());
+    });
+    suite.measure("Catalogue/filterParticles", n, [&] {
+        auto kept = catalogue.filterParticles([](const std::shared_ptr<Particle>& p) { return p->getFourMomentum().data()[0] > 50000.0; });
+        sink = static_cast<double>(kept.size());
+    });
+    suite.measure("Catalogue/getParticlesByType", n, [&] {
+        sink = static_cast<double>(catalogue.getParticlesByType<Muon>().size());
+    });
+    suite.measure("Catalogue/getParticlesByTypeName", n, [&] {
+        sink = static_cast<double>(catalogue.getParticlesByTypeName("Electron").size());
+    });
+    auto byPz = [](const std::shared_ptr<Particle>& a, const std::shared_ptr<Particle>& b) {
+        return a->getFourMomentum().data()[3] < b->getFourMomentum().data()[3];
+    };
+    auto byEnergy = [](const std::shared_ptr<Particle>& a, const std::shared_ptr<Particle>& b) {
+        return a->getFourMomentum().data()[0] < b->getFourMomentum().data()[0];
+    };
+    // Sorting by pz first gives every repetition the same unsorted starting order
+    suite.measure("Catalogue/sortParticles", n, [&] { catalogue.sortParticles(byPz); }, [&] {
+        catalogue.sortParticles(byEnergy);
+    });
+
+    // Muons -> isolated -> pT > 20 GeV -> top 4 by energy, materialized step by step and as one lazy query
+    suite.measure("Query/topMuonsEager", n, [&] {
+        std::vector<std::shared_ptr<Particle>> selected;
+        for (const auto& muon : catalogue.getParticlesByType<Muon>()) {
+            FourMomentum p = muon->getFourMomentum();
+            if (muon->isIsolated() && std::hypot(p.getComponent(1), p.getComponent(2)) > 20000.0) selected.push_back(muon);
+        }
+        std::sort(selected.begin(), selected.end(), [&](const auto& a, const auto& b) { return byEnergy(b, a); });
+        selected.resize(std::min<size_t>(selected.size(), 4));
+        sink = static_cast<double>(selected.size());
+    });
+    auto topMuons = catalogue.query().ofType<Muon>()
+        .where([](const Particle& p) { return p.isIsolated(); })
+        .inRange(QueryKey::Pt, 20000.0)
+        .orderBy(QueryKey::Energy, true)
+        .limit(4);
+    suite.measure("Query/topMuons", n, [&] {
+        sink = static_cast<double>(topMuons.particles().size());
+    });
+    suite.measure("Query/topMuonsParallel", n, [&] {
+        sink = static_cast<double>(ParticleQuery(topMuons).parallel().particles().size());
+    });
+
+    // The sink only counts bytes, so formatting is measured rather than I/O
+    size_t exported = 0;
+    auto countBytes = [&](const char*, size_t size) { exported += size; };
+    for (ExportFormat format : {ExportFormat::Csv, ExportFormat::JsonLines, ExportFormat::Text}) {
+        const char* formatName = format == ExportFormat::Csv ? "Csv" : format == ExportFormat::JsonLines ? "JsonLines" : "Text";
+        CatalogueExporter::Config config;
+        config.format = format;
+        suite.measure(std::string("Export/") + formatName, n, [&] {
+            CatalogueExporter(config).write(catalogue, countBytes);
+        });
+        config.threads = 0;
+        suite.measure(std::string("Export/") + formatName + "Parallel", n, [&] {
+            CatalogueExporter(config).write(catalogue, countBytes);
+        });
+    }
+    sink = static_cast<double>(exported);
+}
+
+bool parseOptions(int argc, char** argv, Options& options) {
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (i + 1 >= argc) {
+            std::cerr << "Missing value for " << arg << std::endl;
+            return false;
+        }
+        const char* value = argv[++i];
+        if (arg == "--min-size") options.minSize = static_cast<size_t>(std::strtod(value, nullptr));
+        else if (arg == "--max-size") options.maxSize = static_cast<size_t>(std::strtod(value, nullptr));
+        else if (arg == "--repetitions") options.repetitions = std::max(1, std::atoi(value));
+        else if (arg == "--format") options.format = value;
+        else if (arg == "--output") options.output = value;
+        else if (arg == "--filter") options.filter = value;
+        else {
+            std::cerr << "Unknown option " << arg << std::endl;
+            return false;
+        }
+    }
+    if (options.format != "json" && options.format != "csv") {
+        std::cerr << "Format must be json or csv" << std::endl;
+        return false;
+    }
+    return options.minSize > 0 && options.minSize <= options.maxSize;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options options;
+    if (!parseOptions(argc, argv, options)) {
+        std::cerr << "Usage: " << argv[0] << " [--min-size N] [--max-size N] [--repetitions R] [--format json|csv] [--output PATH] [--filter SUBSTRING]" << std::endl;
+        return 1;
+    }
+
+    Suite suite(options);
+    for (size_t n = options.minSize; n <= options.maxSize; n *= 10) {
+        std::mt19937_64 rng(42 + n);
+        fourMomentumBenchmarks(suite, n, rng);
+        constructionBenchmarks(suite, n, rng);
+        catalogueBenchmarks(suite, n, rng);
+        if (n > options.maxSize / 10) break;
+    }
+
+    if (options.output.empty()) {
+        suite.write(std::cout);
+    } else {
+        std::ofstream out(options.output);
+        if (!out) {
+            std::cerr << "Cannot write " << options.output << std::endl;
+            return 1;
+        }
+        suite.write(out);
+    }
+    return 0;
+}
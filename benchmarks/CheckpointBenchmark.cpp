@@ -0,0 +1,91 @@
+// Cost of periodic incremental checkpoints during ingestion, then restore of the log,
+// checked against the ingested catalogue, and recovery from a torn final chunk.
+// Usage: CheckpointBenchmark [rounds] [events per round] [threads] [log path]
+#include "../CatalogueCheckpoint.h"
+#include "../EventGenerator.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <string>
+
+namespace {
+
+template<typename Fn>
+double timeMs(Fn&& fn) {
+    auto start = std::chrono::steady_clock::now();
+    fn();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+bool sameTotals(const ParticleCatalogue& a, const ParticleCatalogue& b) {
+    if (a.getTotalNumberOfParticles() != b.getTotalNumberOfParticles()) return false;
+    FourMomentum pa = a.getTotalFourMomentum(), pb = b.getTotalFourMomentum();
+    for (int i = 0; i < 4; i++) {
+        if (pa.getComponent(i) != pb.getComponent(i)) return false;
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    size_t rounds = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 20;
+    size_t events = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 10000;
+    unsigned threads = argc > 3 ? static_cast<unsigned>(std::strtoul(argv[3], nullptr, 10)) : 0;
+    std::string path = argc > 4 ? argv[4] : (std::filesystem::temp_directory_path() / "CheckpointBenchmark.pccp").string();
+    std::filesystem::remove(path);
+
+    EventGenerator::Config generatorConfig;
+    generatorConfig.catalogueDecayProducts = true;
+    generatorConfig.threads = threads;
+    EventGenerator generator(generatorConfig);
+    CatalogueCheckpoint::Config checkpointConfig;
+    checkpointConfig.threads = threads;
+
+    ParticleCatalogue catalogue;
+    double ingestMs = 0.0, checkpointMs = 0.0;
+    {
+        CatalogueCheckpoint log(path, checkpointConfig);
+        std::printf("%6s %12s %12s %14s %12s\n", "round", "rows", "ingest [ms]", "checkpoint [ms]", "log [MB]");
+        for (size_t round = 0; round < rounds; round++) {
+            double ingest = timeMs([&] { generator.fill(catalogue, round * events, events); });
+            double checkpoint = timeMs([&] { log.checkpoint(catalogue); });
+            ingestMs += ingest;
+            checkpointMs += checkpoint;
+            std::printf("%6zu %12zu %12.1f %14.1f %12.1f\n", round, log.persistedRows(), ingest, checkpoint,
+                        std::filesystem::file_size(path) / 1e6);
+        }
+        std::printf("checkpoint/ingest time: %.3f, %zu chunks\n", checkpointMs / ingestMs, log.chunkCount());
+    }
+
+    bool ok = true;
+    ParticleCatalogue restored;
+    CatalogueCheckpoint::RestoreSummary summary;
+    double restoreMs = timeMs([&] { summary = CatalogueCheckpoint::restore(path, restored, threads); });
+    bool match = summary.discardedBytes == 0 && sameTotals(catalogue, restored);
+    ok = ok && match;
+    std::printf("restore: %zu chunks, %zu rows in %.1f ms (%.0f rows/s) %s\n", summary.chunks, summary.rows, restoreMs,
+                summary.rows / (restoreMs * 1e-3), match ? "ok" : "MISMATCH");
+
+    // Tear the final chunk as a crash mid-append would; the chunks before it must survive
+    std::uintmax_t size = std::filesystem::file_size(path);
+    std::filesystem::resize_file(path, size - 1);
+    ParticleCatalogue partial;
+    summary = CatalogueCheckpoint::restore(path, partial, threads);
+    bool torn = summary.discardedBytes > 0 && summary.rows < catalogue.getTotalNumberOfParticles() && summary.rows > 0;
+    {
+        CatalogueCheckpoint reopened(path, checkpointConfig);
+        torn = torn && reopened.persistedRows() == summary.rows && std::filesystem::file_size(path) == size - 1 - summary.discardedBytes;
+        // Appending resumes after the last good chunk
+        reopened.checkpoint(catalogue);
+    }
+    ParticleCatalogue repaired;
+    summary = CatalogueCheckpoint::restore(path, repaired, threads);
+    torn = torn && summary.discardedBytes == 0 && sameTotals(catalogue, repaired);
+    ok = ok && torn;
+    std::printf("torn tail recovery: %s\n", torn ? "ok" : "FAILED");
+
+    std::filesystem::remove(path);
+    return ok ? 0 : 1;
+}
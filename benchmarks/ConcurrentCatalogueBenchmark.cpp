@@ -0,0 +1,166 @@
+// Mixed reader/writer load on ConcurrentParticleCatalogue, compared with a ParticleCatalogue
+// behind one mutex. Writers append prebuilt muons while readers keep taking snapshots and
+// checking them: counts must add up to the snapshot size, a reader's snapshots must never
+// shrink, and the final totals must be exact (every energy is a small integer). A last
+// single-threaded pass checks that a thread appending after clear() reuses its segment.
+// Exits with status 1 if a check fails.
+// Usage: ConcurrentCatalogueBenchmark [particlesPerWriter] [writers] [readers]
+#include "../ConcurrentParticleCatalogue.h"
+#include "../Lepton.h"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace {
+
+std::atomic<bool> failed{false};
+
+void fail(const char* message) {
+    if (!failed.exchange(true)) std::fprintf(stderr, "FAILED: %s\n", message);
+}
+
+// Writer w appends muons with E = 1000 + i % 8 and zero momentum
+std::vector<std::vector<std::shared_ptr<Particle>>> makeParticles(unsigned writers, size_t perWriter) {
+    std::vector<std::vector<std::shared_ptr<Particle>>> particles(writers);
+    for (auto& list : particles) {
+        list.reserve(perWriter);
+        for (size_t i = 0; i < perWriter; i++) {
+            list.push_back(std::make_shared<Muon>(i % 2 ? 1.0 : -1.0, 0.5, FourMomentum(1000.0 + static_cast<double>(i % 8), 0.0, 0.0, 0.0), false));
+        }
+    }
+    return particles;
+}
+
+double expectedEnergy(size_t n) {
+    double total = 0.0;
+    for (size_t i = 0; i < n; i++) total += 1000.0 + static_cast<double>(i % 8);
+    return total;
+}
+
+struct Result {
+    double seconds = 0.0;
+    size_t snapshots = 0;
+};
+
+// Runs the writers to completion while the readers loop; returns the writers' wall time
+template<typename Write, typename Read>
+Result run(unsigned writers, unsigned readers, Write&& write, Read&& read) {
+    std::atomic<bool> done{false};
+    std::atomic<size_t> snapshots{0};
+    std::vector<std::thread> readerThreads;
+    for (unsigned r = 0; r < readers; r++) {
+        readerThreads.emplace_back([&] {
+            size_t local = 0, previous = 0;
+            while (!done.load(std::memory_order_acquire)) {
+                previous = read(previous);
+                local++;
+            }
+            snapshots.fetch_add(local);
+        });
+    }
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> writerThreads;
+    for (unsigned w = 0; w < writers; w++) writerThreads.emplace_back([&, w] { write(w); });
+    for (auto& thread : writerThreads) thread.join();
+    Result result;
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    done.store(true, std::memory_order_release);
+    for (auto& thread : readerThreads) thread.join();
+    result.snapshots = snapshots.load();
+    return result;
+}
+
+void report(const char* name, size_t appends, const Result& result) {
+    std::printf("%-26s %12.2f %14.0f %12zu\n", name, result.seconds * 1e3, appends / result.seconds, result.snapshots);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    size_t perWriter = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 500000;
+    unsigned writers = argc > 2 ? static_cast<unsigned>(std::strtoul(argv[2], nullptr, 10)) : std::max(1u, std::thread::hardware_concurrency());
+    unsigned readers = argc > 3 ? static_cast<unsigned>(std::strtoul(argv[3], nullptr, 10)) : 2;
+    const size_t total = perWriter * writers;
+    auto particles = makeParticles(writers, perWriter);
+
+    std::printf("writers=%u readers=%u particles=%zu\n", writers, readers, total);
+    std::printf("%-26s %12s %14s %12s\n", "catalogue", "write [ms]", "appends/s", "snapshots");
+
+    {
+        ParticleCatalogue catalogue;
+        std::mutex mutex;
+        Result result = run(writers, readers,
+            [&](unsigned w) {
+                for (const auto& particle : particles[w]) {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    catalogue.addParticle(particle);
+                }
+            },
+            [&](size_t previous) {
+                std::lock_guard<std::mutex> lock(mutex);
+                size_t size = catalogue.getTotalNumberOfParticles();
+                if (catalogue.getTotalFourMomentum().getComponent(0) < 1000.0 * static_cast<double>(size)) fail("mutex catalogue total");
+                return std::max(previous, size);
+            });
+        report("ParticleCatalogue+mutex", total, result);
+    }
+
+    auto check = [&](const ConcurrentParticleCatalogue::Snapshot& snapshot, size_t previous) {
+        size_t size = snapshot.getTotalNumberOfParticles();
+        if (size < previous) fail("snapshot shrank");
+        size_t counted = 0;
+        for (const auto& count : snapshot.getParticleCounts()) counted += static_cast<size_t>(count.second);
+        if (counted != size) fail("snapshot counts do not add up to its size");
+        double E = snapshot.getTotalFourMomentum().getComponent(0);
+        if (E < 1000.0 * static_cast<double>(size) || E > 1007.0 * static_cast<double>(size)) fail("snapshot energy out of range");
+        return size;
+    };
+    auto verify = [&](const ConcurrentParticleCatalogue& catalogue) {
+        ConcurrentParticleCatalogue::Snapshot snapshot = catalogue.snapshot();
+        if (snapshot.getTotalNumberOfParticles() != total) fail("particles lost");
+        if (snapshot.getTotalFourMomentum().getComponent(0) != expectedEnergy(perWriter) * writers) fail("final energy");
+        if (snapshot.getParticleCounts()["Muon"] != static_cast<int>(total)) fail("final counts");
+    };
+
+    {
+        ConcurrentParticleCatalogue catalogue;
+        Result result = run(writers, readers,
+            [&](unsigned w) {
+                ConcurrentParticleCatalogue::Writer writer = catalogue.writer();
+                for (const auto& particle : particles[w]) writer.addParticle(particle);
+            },
+            [&](size_t previous) { return check(catalogue.snapshot(), previous); });
+        verify(catalogue);
+        report("Concurrent (writer)", total, result);
+
+        // The thread-local path; these writer threads are new, so each registers a fresh
+        // segment and the cleared ones stay empty
+        catalogue.clear();
+        result = run(writers, readers,
+            [&](unsigned w) {
+                for (const auto& particle : particles[w]) catalogue.addParticle(particle);
+            },
+            [&](size_t previous) { return check(catalogue.snapshot(), previous); });
+        verify(catalogue);
+        report("Concurrent (addParticle)", total, result);
+    }
+
+    // A thread that appends again after clear() must reuse its cached, cleared segment
+    {
+        ConcurrentParticleCatalogue catalogue;
+        for (int round = 0; round < 2; round++) {
+            catalogue.clear();
+            for (const auto& particle : particles[0]) catalogue.addParticle(particle);
+            ConcurrentParticleCatalogue::Snapshot snapshot = catalogue.snapshot();
+            if (snapshot.getTotalNumberOfParticles() != perWriter) fail("particles lost after clear");
+            if (snapshot.getTotalFourMomentum().getComponent(0) != expectedEnergy(perWriter)) fail("energy after clear");
+        }
+        if (catalogue.segmentCount() != 1) fail("cleared segment not reused");
+    }
+
+    return failed ? 1 : 0;
+}
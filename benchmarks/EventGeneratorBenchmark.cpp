@@ -0,0 +1,40 @@
+// Generation rate of the synthetic event generator at increasing thread counts.
+// Usage: EventGeneratorBenchmark [events] [maxThreads] [seed]
+#include "../EventGenerator.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+
+namespace {
+
+template<typename Fn>
+double timeMs(Fn&& fn) {
+    auto start = std::chrono::steady_clock::now();
+    fn();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    size_t events = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 100000;
+    unsigned maxThreads = argc > 2 ? static_cast<unsigned>(std::strtoul(argv[2], nullptr, 10)) : std::max(1u, std::thread::hardware_concurrency());
+    EventGenerator::Config config;
+    config.seed = argc > 3 ? std::strtoull(argv[3], nullptr, 10) : 1;
+    config.catalogueDecayProducts = true;
+
+    std::printf("events=%zu seed=%llu\n", events, static_cast<unsigned long long>(config.seed));
+    std::printf("%8s %12s %12s %14s %s\n", "threads", "particles", "time [ms]", "particles/s", "sum E");
+    for (unsigned threads = 1; threads <= maxThreads; threads = threads < maxThreads && threads * 2 > maxThreads ? maxThreads : threads * 2) {
+        config.threads = threads;
+        EventGenerator generator(config);
+        ParticleCatalogue catalogue;
+        size_t particles = 0;
+        double ms = timeMs([&] { particles = generator.fill(catalogue, 0, events); });
+        // The sum is identical for every thread count
+        std::printf("%8u %12zu %12.1f %14.0f %.17g\n", threads, particles, ms, particles / (ms * 1e-3), catalogue.getTotalFourMomentum().getComponent(0));
+        if (threads == maxThreads) break;
+    }
+    return 0;
+}
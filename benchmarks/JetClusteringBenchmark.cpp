@@ -0,0 +1,147 @@
+// Jet clustering timings for synthetic events: a soft background with exponential pT spread
+// over |y| < 5 plus a few collimated hard jets. Results for the smaller events are checked
+// against a direct O(N^3) implementation of the same algorithms.
+// Usage: JetClusteringBenchmark [events per size]
+#include "../JetClustering.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+namespace {
+
+constexpr double pi = 3.14159265358979323846;
+
+// Charged pions; the mass keeps E safely above |p| after rounding
+FourMomentum pion(double pt, double y, double phi) {
+    double mt = std::sqrt(pt * pt + 139.57 * 139.57);
+    return FourMomentum(mt * std::cosh(y), pt * std::cos(phi), pt * std::sin(phi), mt * std::sinh(y));
+}
+
+std::vector<FourMomentum> makeEvent(std::mt19937_64& rng, size_t soft) {
+    std::uniform_real_distribution<double> rapidity(-5.0, 5.0), azimuth(0.0, 2.0 * pi);
+    std::exponential_distribution<double> softPt(1.0 / 500.0);
+    std::normal_distribution<double> spread(0.0, 0.1);
+    std::vector<FourMomentum> event;
+    event.reserve(soft + 80);
+    for (size_t i = 0; i < soft; i++) event.push_back(pion(softPt(rng), rapidity(rng), azimuth(rng)));
+    for (int jet = 0; jet < 4; jet++) {
+        double y = rapidity(rng) / 2.0, phi = azimuth(rng);
+        for (int i = 0; i < 20; i++) event.push_back(pion(2500.0 + softPt(rng) * 5.0, y + spread(rng), phi + spread(rng)));
+    }
+    return event;
+}
+
+// Textbook sequential recombination: rescan every pair after each step
+std::vector<Jet> naiveCluster(const JetDefinition& definition, const std::vector<FourMomentum>& inputs) {
+    struct Item { FourMomentum p; std::vector<size_t> constituents; };
+    std::vector<Item> items;
+    for (size_t i = 0; i < inputs.size(); i++) items.push_back({inputs[i], {i}});
+    double exponent = definition.algorithm == JetAlgorithm::AntiKt ? -1.0 : definition.algorithm == JetAlgorithm::Kt ? 1.0 : 0.0;
+    auto factor = [&](const FourMomentum& p) {
+        double kt2 = std::max(1e-300, p.getComponent(1) * p.getComponent(1) + p.getComponent(2) * p.getComponent(2));
+        return exponent == 0.0 ? 1.0 : exponent > 0.0 ? kt2 : 1.0 / kt2;
+    };
+    auto rapidity = [](const FourMomentum& p) { return 0.5 * std::log((p.getComponent(0) + p.getComponent(3)) / (p.getComponent(0) - p.getComponent(3))); };
+    auto phi = [](const FourMomentum& p) { double a = std::atan2(p.getComponent(2), p.getComponent(1)); return a < 0.0 ? a + 2.0 * pi : a; };
+    std::vector<Jet> jets;
+    while (!items.empty()) {
+        size_t bestI = 0, bestJ = items.size();
+        double best = factor(items[0].p);
+        for (size_t i = 0; i < items.size(); i++) {
+            double fi = factor(items[i].p);
+            if (fi < best) { best = fi; bestI = i; bestJ = items.size(); }
+            for (size_t j = i + 1; j < items.size(); j++) {
+                double dy = rapidity(items[i].p) - rapidity(items[j].p);
+                double dphi = std::fabs(phi(items[i].p) - phi(items[j].p));
+                if (dphi > pi) dphi = 2.0 * pi - dphi;
+                double d = std::min(fi, factor(items[j].p)) * (dy * dy + dphi * dphi) / (definition.R * definition.R);
+                if (d < best) { best = d; bestI = i; bestJ = j; }
+            }
+        }
+        if (bestJ == items.size()) {
+            Jet jet{items[bestI].p, items[bestI].constituents};
+            std::sort(jet.constituents.begin(), jet.constituents.end());
+            if (jet.pt() >= definition.ptMin) jets.push_back(jet);
+        } else {
+            items[bestJ].p = items[bestI].p + items[bestJ].p;
+            items[bestJ].constituents.insert(items[bestJ].constituents.end(), items[bestI].constituents.begin(), items[bestI].constituents.end());
+        }
+        items.erase(items.begin() + bestI);
+    }
+    std::stable_sort(jets.begin(), jets.end(), [](const Jet& a, const Jet& b) { return a.pt() > b.pt(); });
+    return jets;
+}
+
+bool sameJets(const std::vector<Jet>& a, const std::vector<Jet>& b) {
+    if (a.size() != b.size()) return false;
+    // Order by first constituent so jets of nearly equal pT compare regardless of rounding
+    auto byConstituent = [](const Jet& x, const Jet& y) { return x.constituents < y.constituents; };
+    std::vector<Jet> x = a, y = b;
+    std::sort(x.begin(), x.end(), byConstituent);
+    std::sort(y.begin(), y.end(), byConstituent);
+    for (size_t i = 0; i < x.size(); i++) {
+        if (x[i].constituents != y[i].constituents) return false;
+        if (std::fabs(x[i].momentum.getComponent(0) - y[i].momentum.getComponent(0)) > 1e-9 * x[i].momentum.getComponent(0)) return false;
+    }
+    return true;
+}
+
+const char* name(JetAlgorithm algorithm) {
+    switch (algorithm) {
+        case JetAlgorithm::AntiKt: return "anti-kT";
+        case JetAlgorithm::CambridgeAachen: return "C/A";
+        case JetAlgorithm::Kt: return "kT";
+    }
+    return "?";
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    int events = argc > 1 ? std::atoi(argv[1]) : 5;
+    const JetAlgorithm algorithms[] = {JetAlgorithm::AntiKt, JetAlgorithm::CambridgeAachen, JetAlgorithm::Kt};
+    std::mt19937_64 rng(42);
+
+    // Validation against the direct implementation, including a large R where every particle
+    // is a neighbour candidate of every other
+    int failures = 0;
+    for (JetAlgorithm algorithm : algorithms) {
+        for (double R : {0.4, 1.0, 2.5}) {
+            JetDefinition definition;
+            definition.algorithm = algorithm;
+            definition.R = R;
+            for (int event = 0; event < 3; event++) {
+                std::vector<FourMomentum> inputs = makeEvent(rng, 120);
+                if (!sameJets(JetClustering(definition).cluster(inputs), naiveCluster(definition, inputs))) {
+                    std::printf("MISMATCH %s R=%.1f event %d\n", name(algorithm), R, event);
+                    failures++;
+                }
+            }
+        }
+    }
+    std::printf("validation against O(N^3) reference: %s\n", failures ? "FAILED" : "ok");
+
+    std::printf("%-8s %8s %12s %12s %8s\n", "algo", "N", "ms/event", "us/particle", "jets>20G");
+    for (JetAlgorithm algorithm : algorithms) {
+        JetDefinition definition;
+        definition.algorithm = algorithm;
+        JetClustering clustering(definition);
+        for (size_t soft : {100, 500, 1000, 2000, 5000, 10000, 20000, 50000}) {
+            std::vector<std::vector<FourMomentum>> sample;
+            for (int event = 0; event < events; event++) sample.push_back(makeEvent(rng, soft));
+            size_t hardJets = 0;
+            auto start = std::chrono::steady_clock::now();
+            for (const auto& inputs : sample) {
+                for (const Jet& jet : clustering.cluster(inputs)) hardJets += jet.pt() > 20000.0;
+            }
+            double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / events;
+            size_t n = sample.front().size();
+            std::printf("%-8s %8zu %12.3f %12.3f %8.1f\n", name(algorithm), n, ms, ms * 1e3 / n, static_cast<double>(hardJets) / events);
+        }
+    }
+    return failures ? 1 : 0;
+}
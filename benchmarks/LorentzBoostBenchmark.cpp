@@ -0,0 +1,93 @@
+// Throughput benchmark for the Lorentz boost and rotation kernels (single core).
+// Usage: LorentzBoostBenchmark [vectors] [repetitions]
+#include "../LorentzTransform.h"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+namespace {
+
+template<typename Fn>
+double timeMs(Fn&& fn) {
+    auto start = std::chrono::steady_clock::now();
+    fn();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+void report(const char* name, double ms, size_t operations, double checksum) {
+    std::printf("%-22s %12.2f %14.1f %.17g\n", name, ms, operations / (ms * 1e3), checksum);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    size_t n = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1000000;
+    int repetitions = argc > 2 ? std::atoi(argv[2]) : 10;
+
+    std::mt19937_64 rng(42);
+    std::uniform_real_distribution<double> momentum(-50000.0, 50000.0);
+    const double muonMass = 105.66;
+    std::vector<FourMomentum> vectors;
+    vectors.reserve(n);
+    std::vector<double> E(n), px(n), py(n), pz(n);
+    for (size_t i = 0; i < n; i++) {
+        px[i] = momentum(rng);
+        py[i] = momentum(rng);
+        pz[i] = momentum(rng);
+        E[i] = std::sqrt(muonMass * muonMass + px[i] * px[i] + py[i] * py[i] + pz[i] * pz[i]);
+        vectors.emplace_back(E[i], px[i], py[i], pz[i]);
+    }
+
+    // Alternating a boost and its inverse keeps the values bounded over many repetitions
+    LorentzBoost forward(0.3, -0.2, 0.6), backward = forward.inverse();
+    Rotation3 rotation = Rotation3::aboutAxis(1.0, 2.0, 3.0, 0.7), unrotation = rotation.inverse();
+    size_t operations = n * static_cast<size_t>(repetitions);
+
+    std::printf("vectors=%zu repetitions=%d\n", n, repetitions);
+    std::printf("%-22s %12s %14s %s\n", "kernel", "time [ms]", "Mops/s/core", "checksum");
+
+    std::vector<FourMomentum> scalar = vectors;
+    double ms = timeMs([&] {
+        for (int r = 0; r < repetitions; r++) {
+            const LorentzBoost& boost = r % 2 ? backward : forward;
+            for (FourMomentum& p : scalar) p = boost.apply(p);
+        }
+    });
+    report("boost scalar", ms, operations, FourMomentum::sum(scalar.data(), n).getComponent(0));
+
+    std::vector<FourMomentum> batch = vectors;
+    ms = timeMs([&] {
+        for (int r = 0; r < repetitions; r++) (r % 2 ? backward : forward).apply(batch.data(), n);
+    });
+    report("boost batch (AoS)", ms, operations, FourMomentum::sum(batch.data(), n).getComponent(0));
+
+    std::vector<double> cE = E, cx = px, cy = py, cz = pz;
+    ms = timeMs([&] {
+        for (int r = 0; r < repetitions; r++) {
+            (r % 2 ? backward : forward).apply(cE.data(), cx.data(), cy.data(), cz.data(), cE.data(), cx.data(), cy.data(), cz.data(), n);
+        }
+    });
+    double columnSum = 0.0;
+    for (double value : cE) columnSum += value;
+    report("boost columns (SoA)", ms, operations, columnSum);
+
+    batch = vectors;
+    ms = timeMs([&] {
+        for (int r = 0; r < repetitions; r++) (r % 2 ? unrotation : rotation).apply(batch.data(), n);
+    });
+    report("rotation batch (AoS)", ms, operations, FourMomentum::sum(batch.data(), n).getComponent(3));
+
+    cx = px, cy = py, cz = pz;
+    ms = timeMs([&] {
+        for (int r = 0; r < repetitions; r++) {
+            (r % 2 ? unrotation : rotation).apply(cx.data(), cy.data(), cz.data(), cx.data(), cy.data(), cz.data(), n);
+        }
+    });
+    columnSum = 0.0;
+    for (double value : cz) columnSum += value;
+    report("rotation columns (SoA)", ms, operations, columnSum);
+    return 0;
+}
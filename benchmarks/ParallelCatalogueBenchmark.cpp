@@ -0,0 +1,60 @@
+// Scaling benchmark for the parallel ParticleCatalogue queries.
+// Usage: ParallelCatalogueBenchmark [particles] [maxThreads]
+#include "../Lepton.h"
+#include "../ParticleCatalogue.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <thread>
+
+namespace {
+
+template<typename Fn>
+double timeMs(Fn&& fn) {
+    auto start = std::chrono::steady_clock::now();
+    fn();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    size_t n = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 2000000;
+    unsigned maxThreads = argc > 2 ? static_cast<unsigned>(std::strtoul(argv[2], nullptr, 10)) : std::max(1u, std::thread::hardware_concurrency());
+
+    ParticleCatalogue catalogue;
+    catalogue.reserve(n);
+    std::mt19937_64 rng(42);
+    std::uniform_real_distribution<double> momentum(-50000.0, 50000.0);
+    const double muonMass = 105.66;
+    for (size_t i = 0; i < n; i++) {
+        double px = momentum(rng), py = momentum(rng), pz = momentum(rng);
+        double E = std::sqrt(muonMass * muonMass + px * px + py * py + pz * pz);
+        catalogue.addParticle(std::make_shared<Muon>(i % 2 ? 1.0 : -1.0, 0.5, FourMomentum(E, px, py, pz), i % 3 == 0));
+    }
+
+    auto highEnergy = [](const std::shared_ptr<Particle>& p) { return p->getFourMomentum().getComponent(0) > 50000.0; };
+    auto byEnergy = [](const std::shared_ptr<Particle>& a, const std::shared_ptr<Particle>& b) {
+        return a->getFourMomentum().getComponent(0) < b->getFourMomentum().getComponent(0);
+    };
+    auto byPz = [](const std::shared_ptr<Particle>& a, const std::shared_ptr<Particle>& b) {
+        return a->getFourMomentum().getComponent(3) < b->getFourMomentum().getComponent(3);
+    };
+
+    std::printf("particles=%zu\n", n);
+    std::printf("%8s %12s %12s %12s %12s %10s\n", "threads", "sum [ms]", "count [ms]", "filter [ms]", "sort [ms]", "sum E");
+    for (unsigned threads = 1; threads <= maxThreads; threads = threads < maxThreads && threads * 2 > maxThreads ? maxThreads : threads * 2) {
+        catalogue.setThreadCount(threads);
+        catalogue.sortParticles(byPz);  // Same starting order every round; energy is uncorrelated with pz
+        FourMomentum total;
+        size_t kept = 0;
+        double sumMs = timeMs([&] { total = catalogue.getTotalFourMomentumParallel(); });
+        double countMs = timeMs([&] { catalogue.getParticleCountsParallel(); });
+        double filterMs = timeMs([&] { kept = catalogue.filterParticlesParallel(highEnergy).size(); });
+        double sortMs = timeMs([&] { catalogue.sortParticlesParallel(byEnergy); });
+        std::printf("%8u %12.2f %12.2f %12.2f %12.2f %.17g (kept %zu)\n", threads, sumMs, countMs, filterMs, sortMs, total.getComponent(0), kept);
+        if (threads == maxThreads) break;
+    }
+    return 0;
+}
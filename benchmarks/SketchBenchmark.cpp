@@ -0,0 +1,122 @@
+// Cost and accuracy of the catalogue sketches: addParticle with sketches enabled against
+// plain ingestion, parallel sketch builds at increasing thread counts, quantile rank error
+// against exact sorted values, and distinct-count error of merged HyperLogLog counters.
+// Usage: SketchBenchmark [events] [maxThreads]
+#include "../EventGenerator.h"
+#include "../Quark.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <set>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace {
+
+template<typename Fn>
+double timeMs(Fn&& fn) {
+    auto start = std::chrono::steady_clock::now();
+    fn();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// |fraction of exact values below the estimate - q|
+double rankError(const std::vector<double>& sorted, double estimate, double q) {
+    double below = static_cast<double>(std::lower_bound(sorted.begin(), sorted.end(), estimate) - sorted.begin());
+    double upTo = static_cast<double>(std::upper_bound(sorted.begin(), sorted.end(), estimate) - sorted.begin());
+    double n = static_cast<double>(sorted.size());
+    if (q * n >= below && q * n <= upTo) return 0.0;
+    return std::min(std::fabs(below / n - q), std::fabs(upTo / n - q));
+}
+
+bool sameSketches(const CatalogueSketches& a, const CatalogueSketches& b) {
+    return a.size() == b.size() && a.energyHistogram().counts() == b.energyHistogram().counts() &&
+           a.ptHistogram().counts() == b.ptHistogram().counts() && a.distinctSpeciesEstimate() == b.distinctSpeciesEstimate();
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    size_t events = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 100000;
+    unsigned maxThreads = argc > 2 ? static_cast<unsigned>(std::strtoul(argv[2], nullptr, 10)) : std::max(1u, std::thread::hardware_concurrency());
+    EventGenerator::Config config;
+    config.catalogueDecayProducts = true;
+    config.threads = 1;
+    EventGenerator generator(config);
+    bool ok = true;
+
+    ParticleCatalogue plain, sketched;
+    sketched.enableSketches();
+    double plainMs = timeMs([&] { generator.fill(plain, 0, events); });
+    double sketchedMs = timeMs([&] { generator.fill(sketched, 0, events); });
+    size_t rows = plain.getTotalNumberOfParticles();
+    std::printf("rows=%zu ingest: plain %.1f ms, with sketches %.1f ms (%+.0f ns/row)\n", rows, plainMs, sketchedMs,
+                (sketchedMs - plainMs) * 1e6 / static_cast<double>(rows));
+
+    std::printf("%8s %12s %s\n", "threads", "build [ms]", "same as incremental");
+    CatalogueSketches reference;
+    for (unsigned threads = 1; threads <= maxThreads; threads = threads < maxThreads && threads * 2 > maxThreads ? maxThreads : threads * 2) {
+        plain.setThreadCount(threads);
+        CatalogueSketches built;
+        double ms = timeMs([&] { built = plain.computeSketches(); });
+        // Histograms and distinct counts are exact functions of the rows; digests may differ
+        // from the incremental ones in merge order only
+        bool same = sameSketches(built, sketched.getSketches());
+        if (threads == 1) {
+            reference = built;
+        } else {
+            same = same && built.energyQuantile(0.5) == reference.energyQuantile(0.5) && built.ptQuantile(0.99) == reference.ptQuantile(0.99);
+        }
+        ok = ok && same;
+        std::printf("%8u %12.1f %s\n", threads, ms, same ? "ok" : "MISMATCH");
+        if (threads == maxThreads) break;
+    }
+
+    std::vector<double> energies(plain.getColumns().energy()), pts;
+    pts.reserve(rows);
+    for (size_t i = 0; i < rows; i++) pts.push_back(std::hypot(plain.getColumns().px()[i], plain.getColumns().py()[i]));
+    std::sort(energies.begin(), energies.end());
+    std::sort(pts.begin(), pts.end());
+    const CatalogueSketches& sketches = sketched.getSketches();
+    std::printf("%8s %14s %14s %14s %12s %12s\n", "q", "exact E", "digest E", "exact pT", "digest pT", "hist pT");
+    double worst = 0.0;
+    for (double q : {0.001, 0.01, 0.1, 0.5, 0.9, 0.99, 0.999}) {
+        double exactE = energies[static_cast<size_t>(q * static_cast<double>(rows - 1))];
+        double exactPt = pts[static_cast<size_t>(q * static_cast<double>(rows - 1))];
+        double digestE = sketches.energyQuantile(q), digestPt = sketches.ptQuantile(q), histPt = sketches.ptHistogram().quantile(q);
+        worst = std::max({worst, rankError(energies, digestE, q), rankError(pts, digestPt, q)});
+        std::printf("%8g %14.1f %14.1f %14.1f %12.1f %12.1f\n", q, exactE, digestE, exactPt, digestPt, histPt);
+    }
+    bool accurate = worst < 0.005;
+    ok = ok && accurate;
+    std::printf("worst digest rank error %.5f %s (%zu energy centroids)\n", worst, accurate ? "ok" : "TOO LARGE",
+                sketches.energyDigest().centroids().size());
+
+    std::set<std::pair<std::string, std::string>> species;
+    for (const auto& particle : plain.getParticles()) {
+        const Quark* quark = dynamic_cast<const Quark*>(particle.get());
+        species.emplace(std::string(particle->getType()), quark ? quark->getColorCharge() : std::string());
+    }
+    double estimate = sketches.distinctSpeciesEstimate();
+    bool speciesOk = std::fabs(estimate - static_cast<double>(species.size())) <= std::max(1.0, 0.05 * static_cast<double>(species.size()));
+    ok = ok && speciesOk;
+    std::printf("distinct (type, colour): exact %zu, estimate %.1f %s\n", species.size(), estimate, speciesOk ? "ok" : "OFF");
+
+    // Overlapping key ranges on four shards, merged
+    const size_t keys = 1000000, shards = 4;
+    HyperLogLog merged;
+    for (size_t shard = 0; shard < shards; shard++) {
+        HyperLogLog counter;
+        for (size_t k = shard * keys / (shards + 1); k < (shard + 2) * keys / (shards + 1); k++) counter.add("key" + std::to_string(k));
+        merged.merge(counter);
+    }
+    double relative = merged.estimate() / static_cast<double>(keys) - 1.0;
+    bool mergedOk = std::fabs(relative) < 0.05;
+    ok = ok && mergedOk;
+    std::printf("merged HyperLogLog: %zu keys, estimate %.0f (%+.2f%%) %s\n", keys, merged.estimate(), 100.0 * relative, mergedOk ? "ok" : "OFF");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,91 @@
+// Loops over the same particles through the polymorphic ParticleCatalogue and through the
+// statically typed TypedParticleCatalogue.
+// Usage: TypedCatalogueBenchmark [particles] [repetitions]
+#include "../TypedParticleCatalogue.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+
+namespace {
+
+volatile double sink;
+
+template<typename Fn>
+double bestMs(int repetitions, Fn&& fn) {
+    double best = 1e300;
+    for (int r = 0; r < repetitions; r++) {
+        auto start = std::chrono::steady_clock::now();
+        fn();
+        best = std::min(best, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+    }
+    return best;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    size_t n = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 2000000;
+    int repetitions = argc > 2 ? std::atoi(argv[2]) : 5;
+
+    // Muons, electrons and neutrinos in equal parts
+    TypedParticleCatalogue typed;
+    typed.reserve<Muon>(n / 3 + 1);
+    typed.reserve<Electron>(n / 3 + 1);
+    typed.reserve<Neutrino>(n / 3 + 1);
+    std::mt19937_64 rng(42);
+    std::uniform_real_distribution<double> momentum(-50000.0, 50000.0);
+    const double muonMass = particleProperties(ParticleId::Muon).mass;
+    for (size_t i = 0; i < n; i++) {
+        double px = momentum(rng), py = momentum(rng), pz = momentum(rng);
+        double p = std::sqrt(px * px + py * py + pz * pz);
+        double charge = i % 2 ? 1.0 : -1.0;
+        switch (i % 3) {
+        case 0: typed.emplace<Muon>(charge, 0.5, FourMomentum(std::sqrt(muonMass * muonMass + p * p), px, py, pz), i % 4 == 0); break;
+        case 1: typed.emplace<Electron>(charge, 0.5, FourMomentum(p + 1.0, px, py, pz), std::vector<double>{p + 1.0}); break;
+        default: typed.emplace<Neutrino>(0.0, 0.5, 1, FourMomentum(p, px, py, pz)); break;
+        }
+    }
+    ParticleCatalogue catalogue;
+    typed.addTo(catalogue);
+    const auto& particles = catalogue.getParticles();
+
+    std::printf("particles=%zu\n", n);
+    std::printf("%-28s %12s\n", "loop", "best [ms]");
+    auto report = [](const char* name, double ms) { std::printf("%-28s %12.3f\n", name, ms); };
+
+    report("sum E / virtual", bestMs(repetitions, [&] {
+        double total = 0.0;
+        for (const auto& particle : particles) total += particle->getFourMomentum().getComponent(0);
+        sink = total;
+    }));
+    report("sum E / columns", bestMs(repetitions, [&] {
+        double total = 0.0;
+        for (double E : catalogue.getColumns().energy()) total += E;
+        sink = total;
+    }));
+    report("sum E / typed", bestMs(repetitions, [&] {
+        double total = 0.0;
+        typed.forEach([&](const auto& particle) { total += StaticDispatch::fourMomentum(particle).getComponent(0); });
+        sink = total;
+    }));
+    report("sum charge / virtual", bestMs(repetitions, [&] {
+        double total = 0.0;
+        for (const auto& particle : particles) total += particle->charge();
+        sink = total;
+    }));
+    report("sum charge / typed", bestMs(repetitions, [&] {
+        sink = typed.getTotalCharge();
+    }));
+    report("isolated muons / virtual", bestMs(repetitions, [&] {
+        size_t count = 0;
+        for (const auto& particle : particles) count += particle->getId() == ParticleId::Muon && particle->isIsolated();
+        sink = static_cast<double>(count);
+    }));
+    report("isolated muons / typed", bestMs(repetitions, [&] {
+        sink = static_cast<double>(typed.countIf<Muon>([](const Muon& muon) { return muon.Muon::isIsolated(); }));
+    }));
+    return 0;
+}
@@ -22,17 +22,17 @@ int main() {
     };
 
     // Create quarks with realistic four-momentum and various color charges
-    double upMass = 2.3;
-    double downMass = 4.8;
-    double charmMass = 1275.0;
+    double upMass = particleProperties(ParticleId::Up).mass;
+    double downMass = particleProperties(ParticleId::Down).mass;
+    double charmMass = particleProperties(ParticleId::Charm).mass;
     double pz = 2.3; // Common pz for illustration, adjust as necessary for each particle
 
-    auto upQuarkRed = createParticle<Quark>("Up", 2/3.0, 0.5, "Red", FourMomentum(calculateEnergy(upMass, 0, 0, pz), 0, 0, pz));
-    auto antiupQuarkAntiRed = createParticle<Quark>("Anti-Up", -2/3.0, 0.5, "Anti-Red", FourMomentum(calculateEnergy(upMass, 0, 0, -pz), 0, 0, -pz));
-    auto downQuarkBlue = createParticle<Quark>("Down", -1/3.0, 0.5, "Blue", FourMomentum(calculateEnergy(downMass, 0, 0, pz), 0, 0, pz));
-    auto antidownQuarkAntiBlue = createParticle<Quark>("Anti-Down", 1/3.0, 0.5, "Anti-Blue", FourMomentum(calculateEnergy(downMass, 0, 0, -pz), 0, 0, -pz));
-    auto charmQuarkGreen = createParticle<Quark>("Charm", 2/3.0, 0.5, "Green", FourMomentum(calculateEnergy(charmMass, 0, 0, pz), 0, 0, pz));
-    auto anticharmQuarkAntiGreen = createParticle<Quark>("Anti-Charm", -2/3.0, 0.5, "Anti-Green", FourMomentum(calculateEnergy(charmMass, 0, 0, -pz), 0, 0, -pz));
+    auto upQuarkRed = createParticle<Quark>(ParticleId::Up, "Red", FourMomentum(calculateEnergy(upMass, 0, 0, pz), 0, 0, pz));
+    auto antiupQuarkAntiRed = createParticle<Quark>(ParticleId::AntiUp, "Anti-Red", FourMomentum(calculateEnergy(upMass, 0, 0, -pz), 0, 0, -pz));
+    auto downQuarkBlue = createParticle<Quark>(ParticleId::Down, "Blue", FourMomentum(calculateEnergy(downMass, 0, 0, pz), 0, 0, pz));
+    auto antidownQuarkAntiBlue = createParticle<Quark>(ParticleId::AntiDown, "Anti-Blue", FourMomentum(calculateEnergy(downMass, 0, 0, -pz), 0, 0, -pz));
+    auto charmQuarkGreen = createParticle<Quark>(ParticleId::Charm, "Green", FourMomentum(calculateEnergy(charmMass, 0, 0, pz), 0, 0, pz));
+    auto anticharmQuarkAntiGreen = createParticle<Quark>(ParticleId::AntiCharm, "Anti-Green", FourMomentum(calculateEnergy(charmMass, 0, 0, -pz), 0, 0, -pz));
 
     catalogue.addParticle(upQuarkRed);
     catalogue.addParticle(antiupQuarkAntiRed);